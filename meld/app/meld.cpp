@@ -9,6 +9,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
 
 using namespace std::string_literals;
@@ -32,6 +33,12 @@ int main(int argc, char* argv[])
     ("parallel,j",
        bpo::value<int>()->default_value(max_concurrency),
        "Maximum parallelism requested for the program")
+    ("max-events-in-flight",
+       bpo::value<std::size_t>(),
+       "Maximum number of events processed concurrently")
+    ("memory-budget",
+       bpo::value<double>(),
+       "Memory budget in MB; the source pauses when the budget is nearly exhausted")
     ("version", ("Print meld version ("s + meld::version() + ")").c_str())
     ("dot-file,g",
        bpo::value<std::string>(), "Produce DOT file representing graph of framework nodes");
@@ -101,9 +108,38 @@ int main(int argc, char* argv[])
     configurations.erase("max_concurrency"); // Remove consumed parameters
   }
 
+  std::optional<std::size_t> max_events_in_flight{};
+  if (auto const* specified_events = configurations.if_contains("max_events_in_flight")) {
+    max_events_in_flight = specified_events->to_number<std::size_t>();
+    configurations.erase("max_events_in_flight");
+  }
+  std::optional<double> memory_budget_mb{};
+  if (auto const* specified_budget = configurations.if_contains("memory_budget_mb")) {
+    memory_budget_mb = specified_budget->to_number<double>();
+    configurations.erase("memory_budget_mb");
+  }
+
   // ...but command-line always wins.
   if (not vm["parallel"].defaulted()) {
     max_concurrency = vm["parallel"].as<int>();
   }
-  meld::run(configurations, std::move(dot_file), max_concurrency);
+  if (vm.count("max-events-in-flight")) {
+    max_events_in_flight = vm["max-events-in-flight"].as<std::size_t>();
+  }
+  if (vm.count("memory-budget")) {
+    memory_budget_mb = vm["memory-budget"].as<double>();
+  }
+  if (max_events_in_flight == 0ull) {
+    std::cerr << "Error: The maximum number of events in flight must be positive.\n";
+    return 3;
+  }
+  if (memory_budget_mb and *memory_budget_mb <= 0.) {
+    std::cerr << "Error: The memory budget must be positive.\n";
+    return 3;
+  }
+  meld::run(configurations,
+            std::move(dot_file),
+            max_concurrency,
+            max_events_in_flight,
+            memory_budget_mb);
 }
@@ -8,9 +8,17 @@ using namespace std::string_literals;
 namespace meld {
   void run(boost::json::object const& configurations,
            std::optional<std::string> dot_file,
-           int const max_parallelism)
+           int const max_parallelism,
+           std::optional<std::size_t> const max_events_in_flight,
+           std::optional<double> const memory_budget_mb)
   {
     framework_graph g{load_source(configurations.at("source").as_object()), max_parallelism};
+    if (max_events_in_flight) {
+      g.limit_events_in_flight(*max_events_in_flight);
+    }
+    if (memory_budget_mb) {
+      g.limit_memory(static_cast<std::size_t>(*memory_budget_mb * 1e6));
+    }
     auto const module_configs = configurations.at("modules").as_object();
     for (auto const& [key, value] : module_configs) {
       load_module(g, key, value.as_object());
@@ -3,12 +3,15 @@
 
 #include "boost/json.hpp"
 
+#include <cstddef>
 #include <optional>
 
 namespace meld {
   void run(boost::json::object const& configurations,
            std::optional<std::string> dot_file,
-           int max_parallelism);
+           int max_parallelism,
+           std::optional<std::size_t> max_events_in_flight,
+           std::optional<double> memory_budget_mb);
 }
 
 #endif // meld_app_run_hpp
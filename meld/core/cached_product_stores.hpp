@@ -1,13 +1,26 @@
 #ifndef meld_core_cached_product_stores_hpp
 #define meld_core_cached_product_stores_hpp
 
-// FIXME: only intended to be used in a single-threaded context as std::map is not
-//        thread-safe.
+// =======================================================================================
+// The cached_product_stores class creates the product stores requested by a source,
+// together with any of their ancestors that have not yet been created.  Sources are
+// expected to visit levels depth-first.  Once a new store is created, all of its cached
+// siblings at the same depth and their descendants have therefore been passed, and they
+// are evicted from the cache.  The cache thus holds at most one store per depth: the
+// chain of ancestors of the most recently created store.
+//
+// FIXME: only intended to be used in a single-threaded context.
+// =======================================================================================
 
 #include "meld/model/fwd.hpp"
 #include "meld/model/level_id.hpp"
 #include "meld/model/product_store.hpp"
 
+#include "boost/container/flat_map.hpp"
+
+#include <cstddef>
+#include <string>
+
 namespace meld {
 
   class cached_product_stores {
@@ -26,14 +39,26 @@ namespace meld {
           ->make_child(id->number(), id->level_name(), source_name_, stage::process));
     }
 
+    // Number of cached stores
+    std::size_t size() const noexcept { return product_stores_.size(); }
+
   private:
     product_store_ptr new_store(product_store_ptr const& store)
     {
+      auto const depth = store->id()->depth();
+      for (auto it = product_stores_.begin(); it != product_stores_.end();) {
+        if (it->second->id()->depth() >= depth) {
+          it = product_stores_.erase(it);
+        }
+        else {
+          ++it;
+        }
+      }
       return product_stores_.try_emplace(store->id()->hash(), store).first->second;
     }
 
     std::string const source_name_{"Source"};
-    std::map<level_id::hash_type, product_store_ptr> product_stores_{};
+    boost::container::flat_map<level_id::hash_type, product_store_ptr> product_stores_{};
   };
 
 }
@@ -12,4 +12,15 @@ namespace meld {
   std::string const& consumer::algorithm() const noexcept { return name_.algorithm(); }
 
   std::vector<std::string> const& consumer::when() const noexcept { return predicates_; }
+
+  void consumer::add_predicate(std::string predicate_name, std::string reason)
+  {
+    predicates_.push_back(predicate_name);
+    added_predicates_.emplace(std::move(predicate_name), std::move(reason));
+  }
+
+  std::map<std::string, std::string> const& consumer::added_predicates() const noexcept
+  {
+    return added_predicates_;
+  }
 }
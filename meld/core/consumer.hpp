@@ -3,6 +3,7 @@
 
 #include "meld/model/algorithm_name.hpp"
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -16,9 +17,15 @@ namespace meld {
     std::string const& algorithm() const noexcept;
     std::vector<std::string> const& when() const noexcept;
 
+    // Adds a predicate to the node's when(...) clause on behalf of the framework.  The
+    // reason is shown in the function graph.
+    void add_predicate(std::string predicate_name, std::string reason);
+    std::map<std::string, std::string> const& added_predicates() const noexcept;
+
   private:
     algorithm_name name_;
     std::vector<std::string> predicates_;
+    std::map<std::string, std::string> added_predicates_;
   };
 }
 
@@ -0,0 +1,24 @@
+#include "meld/core/consumer_counts.hpp"
+
+namespace meld {
+  consumer_counts::consumer_counts(std::map<std::string, std::size_t> const& consumers_per_product,
+                                   std::size_t const num_outputs) :
+    default_count_{num_outputs}
+  {
+    for (auto const& [product_name, count] : consumers_per_product) {
+      product_key const key{product_name};
+      if (key.index() >= counts_.size()) {
+        counts_.resize(key.index() + 1, default_count_);
+      }
+      counts_[key.index()] += count;
+    }
+  }
+
+  std::size_t consumer_counts::for_product(product_key const key) const noexcept
+  {
+    if (key.index() < counts_.size()) {
+      return counts_[key.index()];
+    }
+    return default_count_;
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef meld_core_consumer_counts_hpp
+#define meld_core_consumer_counts_hpp
+
+// =======================================================================================
+// A consumer_counts object records, for each product name, how many graph nodes read the
+// product.  It is assembled by the edge_maker when the graph is finalized, and it is used
+// to release a product as soon as its last consumer has finished with it.  Output nodes
+// read every product in the stores they receive, so each output is a consumer of all
+// products.  A count of zero means that the product is never released early; this is the
+// case for all products of a default-constructed consumer_counts object.
+// =======================================================================================
+
+#include "meld/model/product_key.hpp"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace meld {
+  class consumer_counts {
+  public:
+    consumer_counts() = default;
+    consumer_counts(std::map<std::string, std::size_t> const& consumers_per_product,
+                    std::size_t num_outputs);
+
+    std::size_t for_product(product_key key) const noexcept;
+
+  private:
+    std::vector<std::size_t> counts_{};
+    std::size_t default_count_{};
+  };
+}
+
+#endif // meld_core_consumer_counts_hpp
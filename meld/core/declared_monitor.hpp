@@ -138,6 +138,7 @@ namespace meld {
                  }
                  else if (accessor a; needs_new(store, a)) {
                    call(ft, messages, std::make_index_sequence<N>{});
+                   release_inputs(messages);
                    a->second = true;
                    flag_for(store->id()->hash()).mark_as_processed();
                  }
@@ -170,6 +171,7 @@ namespace meld {
     std::vector<tbb::flow::receiver<message>*> ports() override { return input_ports<N>(join_); }
 
     specified_labels input() const override { return product_labels_; }
+    type_ids input_types() const override { return detail::port_types(input_); }
 
     bool needs_new(product_store_const_ptr const& store, accessor& a)
     {
@@ -1,20 +1,41 @@
 #include "meld/core/declared_output.hpp"
 
+#include <ranges>
+
 namespace meld {
   declared_output::declared_output(algorithm_name name,
                                    std::size_t concurrency,
                                    std::vector<std::string> predicates,
                                    tbb::flow::graph& g,
-                                   detail::output_function_t&& ft) :
+                                   detail::output_function_t&& ft,
+                                   bool const retain_products) :
     consumer{std::move(name), std::move(predicates)},
-    node_{g, concurrency, [f = std::move(ft)](message const& msg) -> tbb::flow::continue_msg {
+    node_{g,
+          concurrency,
+          [this, f = std::move(ft)](message const& msg) -> tbb::flow::continue_msg {
             if (not msg.store->is_flush()) {
               f(*msg.store);
+              release_products(*msg.store);
             }
             return {};
-          }}
+          }},
+    retain_products_{retain_products}
   {
   }
 
   tbb::flow::receiver<message>& declared_output::port() noexcept { return node_; }
+
+  bool declared_output::retains_products() const noexcept { return retain_products_; }
+
+  void declared_output::set_consumer_counts(consumer_counts counts)
+  {
+    consumer_counts_ = std::move(counts);
+  }
+
+  void declared_output::release_products(product_store const& store) const
+  {
+    for (auto const& key : store | std::views::keys) {
+      store.release_after_use(key, consumer_counts_.for_product(key));
+    }
+  }
 }
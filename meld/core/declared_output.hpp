@@ -3,6 +3,7 @@
 
 #include "meld/concurrency.hpp"
 #include "meld/core/consumer.hpp"
+#include "meld/core/consumer_counts.hpp"
 #include "meld/core/fwd.hpp"
 #include "meld/core/message.hpp"
 #include "meld/core/node_options.hpp"
@@ -31,12 +32,22 @@ namespace meld {
                     std::size_t concurrency,
                     std::vector<std::string> predicates,
                     tbb::flow::graph& g,
-                    detail::output_function_t&& ft);
+                    detail::output_function_t&& ft,
+                    bool retain_products = false);
 
     tbb::flow::receiver<message>& port() noexcept;
 
+    // An output that reads products after its function returns (e.g. by buffering the
+    // stores it receives) must retain them; this disables early release of products for
+    // the entire graph.
+    bool retains_products() const noexcept;
+    void set_consumer_counts(consumer_counts counts);
+    void release_products(product_store const& store) const;
+
   private:
     tbb::flow::function_node<message> node_;
+    bool retain_products_;
+    consumer_counts consumer_counts_{};
   };
 
   using declared_output_ptr = std::unique_ptr<declared_output>;
@@ -57,11 +68,18 @@ namespace meld {
       graph_{g},
       ft_{std::move(f)},
       concurrency_{c},
+      retain_products_{config ? config->get("retain_products", false) : false},
       reg_{std::move(reg)}
     {
       reg_.set([this] { return create(); });
     }
 
+    output_creator& retain_products()
+    {
+      retain_products_ = true;
+      return *this;
+    }
+
   private:
     declared_output_ptr create()
     {
@@ -69,13 +87,15 @@ namespace meld {
                                                concurrency_.value,
                                                node_options_t::release_predicates(),
                                                graph_,
-                                               std::move(ft_));
+                                               std::move(ft_),
+                                               retain_products_);
     }
 
     algorithm_name name_;
     tbb::flow::graph& graph_;
     detail::output_function_t ft_;
     concurrency concurrency_;
+    bool retain_products_;
     registrar<declared_outputs> reg_;
   };
 }
@@ -1,10 +1,14 @@
 #include "meld/core/declared_predicate.hpp"
 
 namespace meld {
-  declared_predicate::declared_predicate(algorithm_name name, std::vector<std::string> predicates) :
-    products_consumer{std::move(name), std::move(predicates)}
+  declared_predicate::declared_predicate(algorithm_name name,
+                                         std::vector<std::string> predicates,
+                                         std::optional<double> const cost) :
+    products_consumer{std::move(name), std::move(predicates)}, declared_cost_{cost}
   {
   }
 
   declared_predicate::~declared_predicate() = default;
+
+  std::optional<double> declared_predicate::cost() const { return declared_cost_; }
 }
@@ -4,6 +4,7 @@
 #include "meld/core/concepts.hpp"
 #include "meld/core/detail/filter_impl.hpp"
 #include "meld/core/detail/port_names.hpp"
+#include "meld/core/end_of_message.hpp"
 #include "meld/core/fwd.hpp"
 #include "meld/core/message.hpp"
 #include "meld/core/products_consumer.hpp"
@@ -22,12 +23,14 @@
 #include "spdlog/spdlog.h"
 
 #include <array>
+#include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <functional>
 #include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <stdexcept>
@@ -38,12 +41,26 @@
 
 namespace meld {
 
+  // How the predicates named in a node's when(...) clause are evaluated.  With
+  // short_circuit evaluation, predicates with declared costs are evaluated cheapest-first:
+  // each is only evaluated for messages that the cheaper ones have accepted (see
+  // framework_graph::evaluate_predicates).
+  enum class predicate_evaluation { all, short_circuit };
+
   class declared_predicate : public products_consumer {
   public:
-    declared_predicate(algorithm_name name, std::vector<std::string> predicates);
+    declared_predicate(algorithm_name name,
+                       std::vector<std::string> predicates,
+                       std::optional<double> cost);
     virtual ~declared_predicate();
 
     virtual tbb::flow::sender<predicate_result>& sender() = 0;
+
+    // The cost of one evaluation in microseconds, if declared by the user
+    std::optional<double> cost() const;
+
+  private:
+    std::optional<double> declared_cost_;
   };
 
   using declared_predicate_ptr = std::unique_ptr<declared_predicate>;
@@ -78,6 +95,14 @@ namespace meld {
       reg_.set([this] { return create(); });
     }
 
+    // Declares the expected cost of one evaluation in microseconds (see
+    // predicate_evaluation)
+    auto& cost(double const microseconds)
+    {
+      cost_ = microseconds;
+      return *this;
+    }
+
     auto& for_each(std::string const& family)
     {
       for (auto& allowed_family : product_labels_ | std::views::transform(to_family)) {
@@ -94,6 +119,7 @@ namespace meld {
       return std::make_unique<complete_predicate>(std::move(name_),
                                                   concurrency_,
                                                   std::move(predicates_),
+                                                  cost_,
                                                   graph_,
                                                   std::move(ft_),
                                                   std::move(input_args_),
@@ -106,6 +132,7 @@ namespace meld {
     function_t ft_;
     InputArgs input_args_;
     std::array<specified_label, N> product_labels_;
+    std::optional<double> cost_{};
     registrar<declared_predicates> reg_;
   };
 
@@ -125,11 +152,12 @@ namespace meld {
     complete_predicate(algorithm_name name,
                        std::size_t concurrency,
                        std::vector<std::string> predicates,
+                       std::optional<double> cost,
                        tbb::flow::graph& g,
                        function_t&& f,
                        InputArgs input,
                        std::array<specified_label, N> product_labels) :
-      declared_predicate{std::move(name), std::move(predicates)},
+      declared_predicate{std::move(name), std::move(predicates), cost},
       product_labels_{std::move(product_labels)},
       input_{std::move(input)},
       join_{make_join_or_none(g, std::make_index_sequence<N>{})},
@@ -147,6 +175,7 @@ namespace meld {
                    }
                    else if (accessor a; results_.insert(a, store->id()->hash())) {
                      bool const rc = call(ft, messages, std::make_index_sequence<N>{});
+                     release_inputs(messages);
                      result = a->second = {msg.eom, message_id, rc};
                      flag_for(store->id()->hash()).mark_as_processed();
                    }
@@ -155,9 +184,11 @@ namespace meld {
                      results_.erase(store->id()->hash());
                    }
                    return result;
-                 }}
+                 }},
+      votes_{g}
     {
       make_edge(join_, predicate_);
+      make_edge(predicate_, votes_);
     }
 
     ~complete_predicate()
@@ -175,8 +206,21 @@ namespace meld {
 
     std::vector<tbb::flow::receiver<message>*> ports() override { return input_ports<N>(join_); }
 
-    tbb::flow::sender<predicate_result>& sender() override { return predicate_; }
+    tbb::flow::sender<predicate_result>& sender() override { return votes_; }
+
+    // A predicate that is not evaluated still votes (against the message) so that the
+    // filters downstream of it can reach their decisions.
+    void reject(std::size_t const msg_id, filter_decision const& decision) override
+    {
+      auto const hash = decision.store_hash();
+      flag_for(hash).mark_as_processed();
+      if (done_with(hash)) {
+        results_.erase(hash);
+      }
+      votes_.try_put({decision.eom, msg_id, false});
+    }
     specified_labels input() const override { return product_labels_; }
+    type_ids input_types() const override { return detail::port_types(input_); }
 
     template <std::size_t... Is>
     bool call(function_t const& ft, messages_t<N> const& messages, std::index_sequence<Is...>)
@@ -191,6 +235,7 @@ namespace meld {
     InputArgs input_;
     join_or_none_t<N> join_;
     tbb::flow::function_node<messages_t<N>, predicate_result> predicate_;
+    tbb::flow::broadcast_node<predicate_result> votes_;
     results_t results_;
     std::atomic<std::size_t> calls_;
   };
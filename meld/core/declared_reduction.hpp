@@ -8,17 +8,25 @@
 #include "meld/core/message.hpp"
 #include "meld/core/node_options.hpp"
 #include "meld/core/products_consumer.hpp"
+#include "meld/core/reduction/combine.hpp"
 #include "meld/core/reduction/send.hpp"
+#include "meld/core/reduction/window.hpp"
 #include "meld/core/registrar.hpp"
 #include "meld/core/store_counters.hpp"
 #include "meld/model/algorithm_name.hpp"
 #include "meld/model/handle.hpp"
+#include "meld/model/level_counter.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/model/product_key.hpp"
 #include "meld/model/product_store.hpp"
 #include "meld/model/qualified_name.hpp"
 
+#include "fmt/format.h"
+#include "oneapi/tbb/concurrent_hash_map.h"
 #include "oneapi/tbb/concurrent_unordered_map.h"
 #include "oneapi/tbb/flow_graph.h"
+#include "oneapi/tbb/task_arena.h"
+#include "spdlog/spdlog.h"
 
 #include <array>
 #include <atomic>
@@ -28,12 +36,14 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <span>
 #include <stdexcept>
 #include <string>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace meld {
   class declared_reduction : public products_consumer {
@@ -44,6 +54,7 @@ namespace meld {
     virtual tbb::flow::sender<message>& sender() = 0;
     virtual tbb::flow::sender<message>& to_output() = 0;
     virtual qualified_names output() const = 0;
+    virtual type_ids output_types() const = 0; // Ordered as the output names
     virtual std::size_t product_count() const = 0;
   };
 
@@ -61,10 +72,14 @@ namespace meld {
 
     static constexpr std::size_t M = 1; // hard-coded for now
     using function_t = FT;
+    using combine_t = std::function<void(R&, R const&)>;
 
     template <typename InitTuple>
     class total_reduction;
 
+    template <typename InitTuple>
+    class window_reduction;
+
   public:
     pre_reduction(registrar<declared_reductions> reg,
                   algorithm_name name,
@@ -92,7 +107,17 @@ namespace meld {
         "The number of function parameters is not the same as the number of returned output "
         "objects.");
       std::ranges::transform(output_keys, output_names_.begin(), to_qualified_name{name_});
-      reg_.set([this] { return create(std::make_tuple()); });
+      if constexpr (requires { R{}; }) {
+        reg_.set([this] { return create(std::make_tuple()); });
+      }
+      else {
+        reg_.set([this]() -> declared_reduction_ptr {
+          throw std::runtime_error(
+            fmt::format("The reduction '{}' must be initialized using the "
+                        "'initialized_with(...)' syntax.",
+                        name_.full()));
+        });
+      }
       return *this;
     }
 
@@ -105,9 +130,28 @@ namespace meld {
       return to(std::array<std::string, M>{std::forward<decltype(ts)>(ts)...});
     }
 
-    auto& for_each(std::string const& level_name)
+    // Additional levels, ordered from inner to outer, declare a rollup reduction: a result
+    // is produced for each level, where the results for the outer levels are formed by
+    // combining the results for the inner levels.  Rollup reductions thus require a
+    // combine function.
+    auto& for_each(std::string const& level_name,
+                   std::convertible_to<std::string> auto&&... outer_level_names)
+    {
+      reduction_intervals_ = {level_name, std::forward<decltype(outer_level_names)>(
+                                            outer_level_names)...};
+      return *this;
+    }
+
+    // Tumbling windows of 'size' consecutive instances of the level (see
+    // reduction/window.hpp)
+    auto& for_each_window(std::string level_name, std::size_t size)
+    {
+      return for_each_window(std::move(level_name), size, size);
+    }
+
+    auto& for_each_window(std::string level_name, std::size_t size, std::size_t stride)
     {
-      reduction_interval_ = level_name;
+      window_ = window_spec{std::move(level_name), size, stride};
       return *this;
     }
 
@@ -117,24 +161,70 @@ namespace meld {
       return *this;
     }
 
+    // Each thread then accumulates its own partial result, which does not require a shared
+    // (e.g. atomic) result type.  The partial results are merged using the combine function
+    // once all contributions for a reduction interval have been made (see
+    // reduction/combine.hpp).
+    auto& combined_with(combine_t combine)
+    {
+      combine_ = std::move(combine);
+      return *this;
+    }
+
+    // Combines the partial results of a combinable result type using its 'merge' function
+    auto& combined()
+      requires combinable<R>
+    {
+      return combined_with([](R& r, R const& partial) { r.merge(partial); });
+    }
+
   private:
+    static std::size_t thread_index()
+    {
+      auto const index = tbb::this_task_arena::current_thread_index();
+      assert(index >= 0);
+      return static_cast<std::size_t>(index);
+    }
+
     template <typename T>
     declared_reduction_ptr create(T init)
     {
-      if (empty(reduction_interval_)) {
+      if (empty(reduction_intervals_)) {
         throw std::runtime_error(
           "The reduction range must be specified using the 'over(...)' syntax.");
       }
+      if (size(reduction_intervals_) > 1ull and not combine_) {
+        throw std::runtime_error(
+          fmt::format("The rollup reduction '{}' requires a combine function.", name_.full()));
+      }
+      if (window_) {
+        if (window_->size == 0ull or window_->stride == 0ull) {
+          throw std::runtime_error(fmt::format(
+            "The window size and stride of the reduction '{}' must be positive.", name_.full()));
+        }
+        return std::make_unique<window_reduction<decltype(init)>>(std::move(name_),
+                                                                  concurrency_,
+                                                                  std::move(predicates_),
+                                                                  graph_,
+                                                                  std::move(ft_),
+                                                                  std::move(combine_),
+                                                                  std::move(init),
+                                                                  std::move(input_args_),
+                                                                  std::move(product_labels_),
+                                                                  std::move(output_names_),
+                                                                  std::move(*window_));
+      }
       return std::make_unique<total_reduction<decltype(init)>>(std::move(name_),
                                                                concurrency_,
                                                                std::move(predicates_),
                                                                graph_,
                                                                std::move(ft_),
+                                                               std::move(combine_),
                                                                std::move(init),
                                                                std::move(input_args_),
                                                                std::move(product_labels_),
                                                                std::move(output_names_),
-                                                               std::move(reduction_interval_));
+                                                               std::move(reduction_intervals_));
     }
 
     algorithm_name name_;
@@ -144,8 +234,10 @@ namespace meld {
     function_t ft_;
     InputArgs input_args_;
     std::array<specified_label, N> product_labels_;
-    std::string reduction_interval_{level_id::base().level_name()};
+    std::vector<std::string> reduction_intervals_{level_id::base().level_name()};
+    std::optional<window_spec> window_{};
     std::array<qualified_name, M> output_names_;
+    combine_t combine_{};
     registrar<declared_reductions> reg_;
   };
 
@@ -161,17 +253,21 @@ namespace meld {
                     std::vector<std::string> predicates,
                     tbb::flow::graph& g,
                     function_t&& f,
+                    combine_t combine,
                     InitTuple initializer,
                     InputArgs input,
                     std::array<specified_label, N> product_labels,
                     std::array<qualified_name, M> output,
-                    std::string reduction_interval) :
+                    std::vector<std::string> reduction_intervals) :
       declared_reduction{std::move(name), std::move(predicates)},
+      combine_{std::move(combine)},
       initializer_{std::move(initializer)},
       product_labels_{std::move(product_labels)},
       input_{std::move(input)},
       output_{std::move(output)},
-      reduction_interval_{std::move(reduction_interval)},
+      output_key_{output_[0].name()},
+      reduction_intervals_(begin(reduction_intervals), end(reduction_intervals)),
+      reduction_interval_{reduction_intervals_.front()},
       join_{make_join_or_none(g, std::make_index_sequence<N>{})},
       reduction_{
         g, concurrency, [this, ft = std::move(f)](messages_t<N> const& messages, auto& outputs) {
@@ -181,37 +277,46 @@ namespace meld {
           auto const& msg = most_derived(messages);
           auto const& [store, original_message_id] = std::tie(msg.store, msg.original_id);
 
-          if (not store->is_flush() and not store->id()->parent(reduction_interval_)) {
-            return;
-          }
-
+          product_store_const_ptr reduction_store;
           if (store->is_flush()) {
             // Downstream nodes always get the flush.
             get<0>(outputs).try_put(msg);
-            if (store->id()->level_name() != reduction_interval_) {
+            if (std::ranges::find(reduction_intervals_, store->id()->level_name_key()) ==
+                end(reduction_intervals_)) {
               return;
             }
-          }
-
-          auto const& reduction_store =
-            store->is_flush() ? store : store->parent(reduction_interval_);
-          assert(reduction_store);
-          auto const& id_hash_for_counter = reduction_store->id()->hash();
-
-          if (store->is_flush()) {
-            counter_for(id_hash_for_counter).set_flush_value(store, original_message_id);
+            reduction_store = store;
+            counter_for(store->id()->hash()).set_flush_value(store, original_message_id);
           }
           else {
-            call(ft, messages, std::make_index_sequence<N>{});
-            counter_for(id_hash_for_counter).increment(store->id()->level_hash());
+            reduction_store = enclosing_interval(*store);
+            if (not reduction_store) {
+              return;
+            }
+            if (combine_) {
+              call_partial(ft, *reduction_store->id(), messages, std::make_index_sequence<N>{});
+            }
+            else {
+              call(ft, messages, std::make_index_sequence<N>{});
+            }
+            release_inputs(messages);
+            counter_for(reduction_store->id()->hash()).increment(store->id()->level_hash());
           }
 
-          if (auto counter = done_with(id_hash_for_counter)) {
+          // For rollup reductions, completing one reduction interval can complete the
+          // enclosing one.
+          while (reduction_store) {
+            auto counter = done_with(reduction_store->id()->hash());
+            if (not counter) {
+              return;
+            }
+            auto outer_store = enclosing_interval(*reduction_store);
             auto parent = reduction_store->make_continuation(this->full_name());
-            commit_(*parent);
+            commit_(*parent, outer_store.get());
             ++product_count_;
             // FIXME: This msg.eom value may be wrong!
             get<0>(outputs).try_put({parent, msg.eom, counter->original_message_id()});
+            reduction_store = std::move(outer_store);
           }
         }}
     {
@@ -229,7 +334,17 @@ namespace meld {
     tbb::flow::sender<message>& sender() override { return output_port<0ull>(reduction_); }
     tbb::flow::sender<message>& to_output() override { return sender(); }
     specified_labels input() const override { return product_labels_; }
+    type_ids input_types() const override { return detail::port_types(input_); }
     qualified_names output() const override { return output_; }
+    type_ids output_types() const override
+    {
+      if constexpr (requires(R& r) { send(r); }) {
+        return {type_id_for<decltype(send(std::declval<R&>()))>()};
+      }
+      else {
+        return {type_id_for<R>()};
+      }
+    }
 
     template <std::size_t... Is>
     void call(function_t const& ft, messages_t<N> const& messages, std::index_sequence<Is...>)
@@ -249,6 +364,64 @@ namespace meld {
       return std::invoke(ft, *it->second, std::get<Is>(input_).retrieve(messages)...);
     }
 
+    // The innermost reduction interval that encloses the store
+    product_store_const_ptr enclosing_interval(product_store const& store) const
+    {
+      for (auto const& key : reduction_intervals_) {
+        if (auto result = store.parent(key)) {
+          return result;
+        }
+      }
+      return nullptr;
+    }
+
+    template <std::size_t... Is>
+    void call_partial(function_t const& ft,
+                      level_id const& interval_id,
+                      messages_t<N> const& messages,
+                      std::index_sequence<Is...>)
+    {
+      ++calls_;
+      return std::invoke(
+        ft, partial_for(interval_id), std::get<Is>(input_).retrieve(messages)...);
+    }
+
+    R& partial_for(level_id const& interval_id)
+    {
+      auto& partial = partials_for(interval_id.hash())[thread_index()];
+      if (not partial) {
+        partial = initialized_object(InitTuple{initializer_},
+                                     std::make_index_sequence<std::tuple_size_v<InitTuple>>{});
+      }
+      return *partial;
+    }
+
+    std::vector<std::unique_ptr<R>>& partials_for(level_id::hash_type const hash)
+    {
+      partials_accessor a;
+      if (not partials_.find(a, hash)) {
+        auto const n_threads = static_cast<std::size_t>(tbb::this_task_arena::max_concurrency());
+        partials_.emplace(a, hash, std::make_unique<partials_t>(n_threads));
+      }
+      return *a->second;
+    }
+
+    std::unique_ptr<R> combined_result(level_id const& id)
+    {
+      // Called only once all contributions for the reduction interval have been made.
+      partials_t partials;
+      if (partials_accessor a; partials_.find(a, id.hash())) {
+        partials = std::move(*a->second);
+        partials_.erase(a);
+      }
+      auto result = combine_in_tree(std::move(partials), combine_);
+      if (not result) {
+        result = initialized_object(InitTuple{initializer_},
+                                    std::make_index_sequence<std::tuple_size_v<InitTuple>>{});
+      }
+      return result;
+    }
+
     std::size_t num_calls() const final { return calls_.load(); }
     std::size_t product_count() const final { return product_count_.load(); }
 
@@ -259,28 +432,282 @@ namespace meld {
         new R{std::forward<std::tuple_element_t<Is, InitTuple>>(std::get<Is>(tuple))...}};
     }
 
-    void commit_(product_store& store)
+    void commit_(product_store& store, product_store const* outer_store)
     {
+      if (combine_) {
+        auto result = combined_result(*store.id());
+        if (outer_store) {
+          // The result contributes to the enclosing reduction interval of a rollup.
+          combine_(partial_for(*outer_store->id()), std::as_const(*result));
+          counter_for(outer_store->id()->hash()).increment(store.id()->level_hash());
+        }
+        if constexpr (requires { send(*result); }) {
+          store.add_product(output_key_, send(*result));
+        }
+        else {
+          store.add_product(output_key_, std::move(*result));
+        }
+        return;
+      }
+
       auto& result = results_.at(*store.id());
       if constexpr (requires { send(*result); }) {
-        store.add_product(output()[0].name(), send(*result));
+        store.add_product(output_key_, send(*result));
       }
       else {
-        store.add_product(output()[0].name(), std::move(*result));
+        store.add_product(output_key_, std::move(*result));
       }
       // Reclaim some memory; it would be better to erase the entire entry from the map,
       // but that is not thread-safe.
       result.reset();
     }
 
+    combine_t combine_;
     InitTuple initializer_;
     std::array<specified_label, N> product_labels_;
     InputArgs input_;
     std::array<qualified_name, M> output_;
-    std::string reduction_interval_;
+    product_key output_key_;
+    std::vector<level_key> reduction_intervals_;
+    level_key reduction_interval_; // Innermost reduction interval
     join_or_none_t<N> join_;
     tbb::flow::multifunction_node<messages_t<N>, messages_t<1>> reduction_;
     tbb::concurrent_unordered_map<level_id, std::unique_ptr<R>> results_;
+
+    // Partial results per reduction interval, indexed by thread
+    using partials_t = std::vector<std::unique_ptr<R>>;
+    using partials_map_t =
+      tbb::concurrent_hash_map<level_id::hash_type, std::unique_ptr<partials_t>>;
+    using partials_accessor = typename partials_map_t::accessor;
+    partials_map_t partials_;
+    std::atomic<std::size_t> calls_;
+    std::atomic<std::size_t> product_count_;
+  };
+
+  // =====================================================================================
+
+  template <is_reduction_like FT, typename InputArgs>
+  template <typename InitTuple>
+  class pre_reduction<FT, InputArgs>::window_reduction :
+    public declared_reduction,
+    private count_stores {
+
+    struct window_state {
+      std::vector<std::unique_ptr<R>> partials; // Per thread, or one shared result
+      std::atomic<std::size_t> contributions{};
+    };
+    using windows_t = tbb::concurrent_hash_map<std::size_t, std::unique_ptr<window_state>>;
+    using window_accessor = typename windows_t::accessor;
+    using parents_t = tbb::concurrent_hash_map<level_id::hash_type, std::unique_ptr<windows_t>>;
+    using parent_accessor = typename parents_t::accessor;
+
+  public:
+    window_reduction(algorithm_name name,
+                     std::size_t concurrency,
+                     std::vector<std::string> predicates,
+                     tbb::flow::graph& g,
+                     function_t&& f,
+                     combine_t combine,
+                     InitTuple initializer,
+                     InputArgs input,
+                     std::array<specified_label, N> product_labels,
+                     std::array<qualified_name, M> output,
+                     window_spec window) :
+      declared_reduction{std::move(name), std::move(predicates)},
+      combine_{std::move(combine)},
+      initializer_{std::move(initializer)},
+      product_labels_{std::move(product_labels)},
+      input_{std::move(input)},
+      output_{std::move(output)},
+      output_key_{output_[0].name()},
+      window_{std::move(window)},
+      window_level_{window_.level_name},
+      join_{make_join_or_none(g, std::make_index_sequence<N>{})},
+      reduction_{
+        g, concurrency, [this, ft = std::move(f)](messages_t<N> const& messages, auto& outputs) {
+          auto const& msg = most_derived(messages);
+          auto const& store = msg.store;
+
+          if (store->is_flush()) {
+            // Downstream nodes always get the flush.
+            get<0>(outputs).try_put(msg);
+            if (has_window_instances(*store)) {
+              auto const parent_hash = store->id()->hash();
+              counter_for(parent_hash).set_flush_value(store, msg.original_id);
+              discard_windows_if_done(parent_hash);
+            }
+            return;
+          }
+
+          if (store->id()->level_name_key() != window_level_) {
+            return;
+          }
+
+          auto const parent_hash = store->id()->parent()->hash();
+          auto const [first, last] = windows_containing(store->id()->number(), window_);
+          for (auto k = first; k <= last; ++k) {
+            call(ft, window_for(parent_hash, k), messages, std::make_index_sequence<N>{});
+          }
+          release_inputs(messages);
+
+          // A window is complete once all of its instances have contributed to it.
+          for (auto k = first; k <= last; ++k) {
+            if (auto result = completed_result(parent_hash, k)) {
+              auto window_store = store->make_continuation(this->full_name());
+              if constexpr (requires { send(*result); }) {
+                window_store->add_product(output_key_, send(*result));
+              }
+              else {
+                window_store->add_product(output_key_, std::move(*result));
+              }
+              ++product_count_;
+              get<0>(outputs).try_put({window_store, msg.eom, next_message_id()});
+            }
+          }
+
+          counter_for(parent_hash).increment(store->id()->level_hash());
+          discard_windows_if_done(parent_hash);
+        }}
+    {
+      make_edge(join_, reduction_);
+    }
+
+    ~window_reduction()
+    {
+      if (parents_.size() > 0ull) {
+        spdlog::warn("Window reduction {} has incomplete windows for {} parent stores.",
+                     full_name(),
+                     parents_.size());
+      }
+    }
+
+  private:
+    tbb::flow::receiver<message>& port_for(specified_label const& product_label) override
+    {
+      return receiver_for<N>(join_, product_labels_, product_label);
+    }
+
+    std::vector<tbb::flow::receiver<message>*> ports() override { return input_ports<N>(join_); }
+
+    tbb::flow::sender<message>& sender() override { return output_port<0ull>(reduction_); }
+    tbb::flow::sender<message>& to_output() override { return sender(); }
+    specified_labels input() const override { return product_labels_; }
+    type_ids input_types() const override { return detail::port_types(input_); }
+    qualified_names output() const override { return output_; }
+    type_ids output_types() const override
+    {
+      if constexpr (requires(R& r) { send(r); }) {
+        return {type_id_for<decltype(send(std::declval<R&>()))>()};
+      }
+      else {
+        return {type_id_for<R>()};
+      }
+    }
+
+    std::size_t num_calls() const final { return calls_.load(); }
+    std::size_t product_count() const final { return product_count_.load(); }
+
+    // Whether the flushed store has children at the window level
+    bool has_window_instances(product_store const& flush_store) const
+    {
+      if (not flush_store.contains_product(flush_counts_key())) {
+        return false;
+      }
+      auto const& counts = flush_store.get_product<flush_counts_ptr>(flush_counts_key());
+      auto const child_level_hash =
+        flush_store.id()->make_child(0, window_.level_name)->level_hash();
+      return counts->count_for(child_level_hash).has_value();
+    }
+
+    std::unique_ptr<R> new_result() const
+    {
+      return std::apply([](auto const&... ts) { return std::unique_ptr<R>{new R{ts...}}; },
+                        initializer_);
+    }
+
+    window_state& window_for(level_id::hash_type const parent_hash, std::size_t const k)
+    {
+      windows_t* windows = nullptr;
+      if (parent_accessor a; parents_.find(a, parent_hash)) {
+        windows = a->second.get();
+      }
+      else {
+        parents_.emplace(a, parent_hash, std::make_unique<windows_t>());
+        windows = a->second.get();
+      }
+
+      window_accessor a;
+      if (not windows->find(a, k)) {
+        auto state = std::make_unique<window_state>();
+        if (combine_) {
+          state->partials.resize(
+            static_cast<std::size_t>(tbb::this_task_arena::max_concurrency()));
+        }
+        else {
+          state->partials.push_back(new_result());
+        }
+        windows->emplace(a, k, std::move(state));
+      }
+      return *a->second;
+    }
+
+    template <std::size_t... Is>
+    void call(function_t const& ft,
+              window_state& window,
+              messages_t<N> const& messages,
+              std::index_sequence<Is...>)
+    {
+      auto* result = window.partials.front().get();
+      if (combine_) {
+        auto& partial = window.partials[thread_index()];
+        if (not partial) {
+          partial = new_result();
+        }
+        result = partial.get();
+      }
+      ++calls_;
+      std::invoke(ft, *result, std::get<Is>(input_).retrieve(messages)...);
+      ++window.contributions;
+    }
+
+    std::unique_ptr<R> completed_result(level_id::hash_type const parent_hash,
+                                        std::size_t const k)
+    {
+      windows_t* windows = nullptr;
+      if (parent_accessor a; parents_.find(a, parent_hash)) {
+        windows = a->second.get();
+      }
+      assert(windows);
+
+      window_accessor a;
+      if (not windows->find(a, k) or a->second->contributions != window_.size) {
+        return nullptr;
+      }
+      auto partials = std::move(a->second->partials);
+      windows->erase(a);
+      return combine_in_tree(std::move(partials), combine_);
+    }
+
+    void discard_windows_if_done(level_id::hash_type const parent_hash)
+    {
+      // Windows that are incomplete once all instances of the parent have been processed
+      // are never emitted.
+      if (done_with(parent_hash)) {
+        parents_.erase(parent_hash);
+      }
+    }
+
+    combine_t combine_;
+    InitTuple initializer_;
+    std::array<specified_label, N> product_labels_;
+    InputArgs input_;
+    std::array<qualified_name, M> output_;
+    product_key output_key_;
+    window_spec window_;
+    level_key window_level_;
+    join_or_none_t<N> join_;
+    tbb::flow::multifunction_node<messages_t<N>, messages_t<1>> reduction_;
+    parents_t parents_;
     std::atomic<std::size_t> calls_;
     std::atomic<std::size_t> product_count_;
   };
@@ -6,16 +6,24 @@ namespace meld {
 
   generator::generator(product_store_const_ptr const& parent,
                        std::string const& node_name,
-                       std::string const& new_level_name) :
-    parent_{std::const_pointer_cast<product_store>(parent)},
+                       std::string const& new_level_name,
+                       bool const early_release) :
+    parent_{boost::const_pointer_cast<product_store>(parent)},
     node_name_{node_name},
-    new_level_name_{new_level_name}
+    new_level_name_{new_level_name},
+    early_release_{early_release}
   {
   }
 
-  product_store_const_ptr generator::make_child(std::size_t const i, products new_products)
+  product_store_ptr generator::make_child(std::size_t const i, products new_products)
   {
     auto child = parent_->make_child(i, new_level_name_, node_name_, std::move(new_products));
+    // Unless the children are unfolded further, they are read only through the splitter's
+    // own head ports, so no later store can reach their products through its parent chain.
+    if (early_release_) {
+      child->enable_early_release();
+    }
+    std::lock_guard lock{child_counts_mutex_};
     ++child_counts_[child->id()->level_hash()];
     return child;
   }
@@ -24,7 +32,7 @@ namespace meld {
   {
     auto result = parent_->make_flush();
     if (not child_counts_.empty()) {
-      result->add_product("[flush]",
+      result->add_product(flush_counts_key(),
                           std::make_shared<flush_counts const>(std::move(child_counts_)));
     }
     return result;
@@ -36,4 +44,10 @@ namespace meld {
   }
 
   declared_splitter::~declared_splitter() = default;
+
+  void declared_splitter::retain_children_products() noexcept { children_release_early_ = false; }
+  bool declared_splitter::children_release_early() const noexcept
+  {
+    return children_release_early_;
+  }
 }
@@ -13,14 +13,18 @@
 #include "meld/model/algorithm_name.hpp"
 #include "meld/model/handle.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/model/product_key.hpp"
 #include "meld/model/product_store.hpp"
 #include "meld/model/qualified_name.hpp"
 #include "meld/utilities/sized_tuple.hpp"
 
+#include "oneapi/tbb/blocked_range.h"
 #include "oneapi/tbb/concurrent_hash_map.h"
 #include "oneapi/tbb/flow_graph.h"
+#include "oneapi/tbb/parallel_for.h"
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cstddef>
@@ -28,21 +32,39 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <ranges>
 #include <span>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace meld {
 
+  // =====================================================================================
+  // An unfold object that provides a 'size()' member function, and whose running value is
+  // an index, is indexed: its children are numbered 0 through size()-1, and the products
+  // for child i are the second element of the pair returned by 'unfold(i)'.  If requested
+  // with 'in_chunks_of(n)', the children of an indexed object are created in parallel
+  // chunks instead of one after the other, and the predicate is not called.  Otherwise,
+  // an indexed object is unfolded like any other.
+  // =====================================================================================
+  template <typename Object>
+  concept indexed_unfold = requires(Object const& obj) {
+    { obj.size() } -> std::convertible_to<std::size_t>;
+    { obj.initial_value() } -> std::integral;
+  };
+
+  // The generator may create children concurrently.
   class generator {
   public:
     explicit generator(product_store_const_ptr const& parent,
                        std::string const& node_name,
-                       std::string const& new_level_name);
+                       std::string const& new_level_name,
+                       bool early_release);
     product_store_const_ptr flush_store() const;
 
     product_store_const_ptr make_child_for(std::size_t const level_number, products new_products)
@@ -50,11 +72,25 @@ namespace meld {
       return make_child(level_number, std::move(new_products));
     }
 
+    template <std::size_t N, typename Ts>
+    product_store_const_ptr make_child_for(std::size_t const level_number,
+                                           std::array<product_key, N> const& keys,
+                                           Ts&& ts)
+    {
+      // The products are added after the child is created so that they are allocated
+      // from the child's arena.
+      auto child = make_child(level_number, products{});
+      child->add_products(keys, std::forward<Ts>(ts));
+      return child;
+    }
+
   private:
-    product_store_const_ptr make_child(std::size_t i, products new_products);
+    product_store_ptr make_child(std::size_t i, products new_products);
     product_store_ptr parent_;
-    std::string_view node_name_;
+    std::string node_name_;
     std::string const& new_level_name_;
+    bool early_release_;
+    std::mutex child_counts_mutex_;
     std::map<level_id::hash_type, std::size_t> child_counts_;
   };
 
@@ -68,6 +104,15 @@ namespace meld {
     virtual void finalize(multiplexer::head_ports_t head_ports) = 0;
     virtual std::size_t product_count() const = 0;
     virtual multiplexer::head_ports_t const& downstream_ports() const = 0;
+
+    // The products of a child may be read by each of the child's own children, whose uses
+    // are not accounted for by the consumer counts.  Children that may be unfolded further
+    // therefore retain their products until they are destroyed.
+    void retain_children_products() noexcept;
+    bool children_release_early() const noexcept;
+
+  private:
+    bool children_release_early_{true};
   };
 
   using declared_splitter_ptr = std::unique_ptr<declared_splitter>;
@@ -123,6 +168,24 @@ namespace meld {
       return *this;
     }
 
+    // Creates the children of an indexed object (see indexed_unfold) in parallel, with at
+    // most 'chunk_size' children created by one task.
+    auto& in_chunks_of(std::size_t chunk_size)
+      requires indexed_unfold<Object>
+    {
+      chunk_size_ = std::max(chunk_size, std::size_t{1});
+      return *this;
+    }
+
+    // Children are then created lazily: at most 'max_children' children of each parent
+    // are being processed at any one time, and the unfold resumes whenever a child has been
+    // processed.  The unfold's input products are released once the unfold has finished.
+    auto& limit_outstanding_children(std::size_t max_children)
+    {
+      max_outstanding_children_ = max_children;
+      return *this;
+    }
+
   private:
     template <std::size_t M>
     declared_splitter_ptr create(std::array<qualified_name, M> outputs)
@@ -136,7 +199,9 @@ namespace meld {
                                                     std::move(input_args_),
                                                     std::move(product_labels_),
                                                     std::move(outputs),
-                                                    std::move(new_level_name_));
+                                                    std::move(new_level_name_),
+                                                    chunk_size_,
+                                                    max_outstanding_children_);
     }
 
     algorithm_name name_;
@@ -148,6 +213,8 @@ namespace meld {
     InputArgs input_args_;
     std::array<specified_label, N> product_labels_;
     std::string new_level_name_;
+    std::size_t chunk_size_{};               // Zero for unfolding with the predicate
+    std::size_t max_outstanding_children_{}; // Zero for eager unfolding
     registrar<declared_splitters> reg_;
   };
 
@@ -162,6 +229,43 @@ namespace meld {
     using accessor = stores_t::accessor;
     using const_accessor = stores_t::const_accessor;
 
+    // State of a lazy unfold, which is resumed whenever one of its children is released
+    struct unfold_state {
+      template <typename... Args>
+      unfold_state(product_store_const_ptr const& parent,
+                   std::string const& node_name,
+                   std::string const& new_level_name,
+                   bool early_release,
+                   end_of_message_ptr parent_eom,
+                   messages_t<N> const& input_messages,
+                   std::size_t original_id,
+                   Args&&... args) :
+        obj(std::forward<Args>(args)...),
+        running_value(obj.initial_value()),
+        gen{parent, node_name, new_level_name, early_release},
+        eom{std::move(parent_eom)},
+        messages{input_messages},
+        original_message_id{original_id}
+      {
+      }
+
+      std::mutex mutex;
+      Object obj;
+      std::decay_t<decltype(std::declval<Object const&>().initial_value())> running_value;
+      generator gen;
+      end_of_message_ptr eom;
+      messages_t<N> messages;
+      std::size_t original_message_id;
+      std::size_t counter{};
+      std::atomic<std::size_t> outstanding{};
+      std::atomic<bool> finished{false};
+    };
+    using unfold_state_ptr = std::shared_ptr<unfold_state>;
+
+    // New parents to unfold and lazy unfolds to resume are processed by the same node, so
+    // that the splitter's concurrency bounds all invocations of the user's functions.
+    using unfold_work = std::variant<messages_t<N>, unfold_state_ptr>;
+
   public:
     complete_splitter(algorithm_name name,
                       std::size_t concurrency,
@@ -172,29 +276,53 @@ namespace meld {
                       InputArgs input,
                       std::array<specified_label, N> product_labels,
                       std::array<qualified_name, M> output_products,
-                      std::string new_level_name) :
+                      std::string new_level_name,
+                      std::size_t chunk_size,
+                      std::size_t max_outstanding_children) :
       declared_splitter{std::move(name), std::move(predicates)},
       product_labels_{std::move(product_labels)},
       input_{std::move(input)},
       output_{std::move(output_products)},
+      output_keys_{to_product_keys(output_)},
       new_level_name_{std::move(new_level_name)},
+      chunk_size_{chunk_size},
+      max_outstanding_children_{max_outstanding_children},
+      predicate_{std::move(predicate)},
+      unfold_{std::move(unfold)},
       multiplexer_{g},
       join_{make_join_or_none(g, std::make_index_sequence<N>{})},
+      to_work_{g,
+               tbb::flow::unlimited,
+               [](messages_t<N> const& messages) -> unfold_work { return messages; }},
       splitter_{g,
                 concurrency,
-                [this, p = std::move(predicate), ufold = std::move(unfold)](
-                  messages_t<N> const& messages) -> tbb::flow::continue_msg {
+                [this](unfold_work const& work) -> tbb::flow::continue_msg {
+                  if (auto const* state = std::get_if<unfold_state_ptr>(&work)) {
+                    emit_children(*state);
+                    return {};
+                  }
+                  auto const& messages = std::get<messages_t<N>>(work);
                   auto const& msg = most_derived(messages);
                   auto const& store = msg.store;
                   if (store->is_flush()) {
                     flag_for(store->id()->hash()).flush_received(msg.id);
                   }
                   else if (accessor a; stores_.insert(a, store->id()->hash())) {
-                    std::size_t const original_message_id{msg_counter_};
-                    generator g{msg.store, this->full_name(), new_level_name_};
-                    call(p, ufold, g, msg.eom, messages, std::make_index_sequence<N>{});
-                    multiplexer_.try_put(
-                      {g.flush_store(), msg.eom, ++msg_counter_, original_message_id});
+                    std::size_t const original_message_id{msg.id};
+                    if (max_outstanding_children_ > 0ull) {
+                      emit_children(start_unfold(
+                        msg, messages, original_message_id, std::make_index_sequence<N>{}));
+                    }
+                    else {
+                      generator g{msg.store,
+                                  this->full_name(),
+                                  new_level_name_,
+                                  this->children_release_early()};
+                      call(g, msg.eom, messages, std::make_index_sequence<N>{});
+                      release_inputs(messages);
+                      multiplexer_.try_put(
+                        {g.flush_store(), msg.eom, next_message_id(), original_message_id});
+                    }
                     flag_for(store->id()->hash()).mark_as_processed();
                   }
 
@@ -205,7 +333,8 @@ namespace meld {
                 }},
       to_output_{g}
     {
-      make_edge(join_, splitter_);
+      make_edge(join_, to_work_);
+      make_edge(to_work_, splitter_);
       make_edge(to_output_, multiplexer_);
     }
 
@@ -214,8 +343,9 @@ namespace meld {
       if (stores_.size() > 0ull) {
         spdlog::warn("Unfold {} has {} cached stores.", full_name(), stores_.size());
       }
-      for (auto const& store : stores_ | std::views::values) {
-        spdlog::debug(" => ID: ", store->id()->to_string());
+      // The cached entries only record which stores have been unfolded; they hold no stores.
+      for (auto const& hash : stores_ | std::views::keys) {
+        spdlog::debug(" => hash: {}", hash);
       }
     }
 
@@ -229,6 +359,7 @@ namespace meld {
     tbb::flow::sender<message>& to_output() override { return to_output_; }
 
     specified_labels input() const override { return product_labels_; }
+    type_ids input_types() const override { return detail::port_types(input_); }
     qualified_names output() const override { return output_; }
 
     void finalize(multiplexer::head_ports_t head_ports) override
@@ -242,41 +373,121 @@ namespace meld {
     }
 
     template <std::size_t... Is>
-    void call(Predicate const& predicate,
-              Unfold const& unfold,
-              generator& g,
+    unfold_state_ptr start_unfold(message const& msg,
+                                  messages_t<N> const& messages,
+                                  std::size_t const original_message_id,
+                                  std::index_sequence<Is...>)
+    {
+      ++calls_;
+      return std::make_shared<unfold_state>(msg.store,
+                                            this->full_name(),
+                                            new_level_name_,
+                                            this->children_release_early(),
+                                            msg.eom,
+                                            messages,
+                                            original_message_id,
+                                            std::get<Is>(input_).retrieve(messages)...);
+    }
+
+    void emit_children(unfold_state_ptr const& state)
+    {
+      std::lock_guard lock{state->mutex};
+      if (state->finished) {
+        return;
+      }
+      while (state->outstanding < max_outstanding_children_) {
+        if (not std::invoke(predicate_, state->obj, state->running_value)) {
+          state->finished = true;
+          release_inputs(state->messages);
+          multiplexer_.try_put({state->gen.flush_store(),
+                                state->eom,
+                                next_message_id(),
+                                state->original_message_id});
+          return;
+        }
+
+        auto [next_value, prods] = std::invoke(unfold_, state->obj, state->running_value);
+        ++product_count_;
+        auto child = state->gen.make_child_for(state->counter++, output_keys_, std::move(prods));
+        auto child_eom = state->eom->make_child(child->id());
+        // The unfold is resumed only when a child is released while the bound has been
+        // reached; otherwise, the loop above (or an already-scheduled resumption) creates the
+        // next child.  The callback may be invoked while the lock is held (e.g. if no node
+        // consumes the child), so it only schedules the resumption.
+        child_eom->on_release([this, state] {
+          if (state->outstanding.fetch_sub(1) == max_outstanding_children_ and
+              not state->finished) {
+            splitter_.try_put(state);
+          }
+        });
+        ++state->outstanding;
+        to_output_.try_put({child, std::move(child_eom), next_message_id()});
+        state->running_value = next_value;
+      }
+    }
+
+    template <std::size_t... Is>
+    void call(generator& g,
               end_of_message_ptr const& eom,
               messages_t<N> const& messages,
               std::index_sequence<Is...>)
     {
+      auto const& predicate = predicate_;
+      auto const& unfold = unfold_;
       ++calls_;
       Object obj(std::get<Is>(input_).retrieve(messages)...);
+      if constexpr (indexed_unfold<Object>) {
+        if (chunk_size_ > 0ull) {
+          call_in_chunks(g, eom, obj);
+          return;
+        }
+      }
       std::size_t counter = 0;
       auto running_value = obj.initial_value();
       while (std::invoke(predicate, obj, running_value)) {
         auto [next_value, prods] = std::invoke(unfold, obj, running_value);
         ++product_count_;
-        products new_products;
-        new_products.add_all(output_, prods);
-        auto child = g.make_child_for(counter++, std::move(new_products));
-        to_output_.try_put({child, eom->make_child(child->id()), ++msg_counter_});
+        auto child = g.make_child_for(counter++, output_keys_, std::move(prods));
+        to_output_.try_put({child, eom->make_child(child->id()), next_message_id()});
         running_value = next_value;
       }
     }
 
+    void call_in_chunks(generator& g, end_of_message_ptr const& eom, Object const& obj)
+      requires indexed_unfold<Object>
+    {
+      auto const& unfold = unfold_;
+      auto const n = static_cast<std::size_t>(obj.size());
+      tbb::parallel_for(tbb::blocked_range<std::size_t>{0, n, chunk_size_},
+                        [this, &obj, &unfold, &g, &eom](auto const& range) {
+                          for (std::size_t i = range.begin(); i != range.end(); ++i) {
+                            auto prods = std::invoke(unfold, obj, i).second;
+                            auto child = g.make_child_for(i, output_keys_, std::move(prods));
+                            to_output_.try_put(
+                              {child, eom->make_child(child->id()), next_message_id()});
+                          }
+                        });
+      product_count_ += n;
+    }
+
     std::size_t num_calls() const final { return calls_.load(); }
     std::size_t product_count() const final { return product_count_.load(); }
 
     std::array<specified_label, N> product_labels_;
     InputArgs input_;
     std::array<qualified_name, M> output_;
+    std::array<product_key, M> output_keys_;
     std::string new_level_name_;
+    std::size_t chunk_size_;
+    std::size_t max_outstanding_children_;
+    Predicate predicate_;
+    Unfold unfold_;
     multiplexer multiplexer_;
     join_or_none_t<N> join_;
-    tbb::flow::function_node<messages_t<N>> splitter_;
+    tbb::flow::function_node<messages_t<N>, unfold_work> to_work_;
+    tbb::flow::function_node<unfold_work> splitter_;
     tbb::flow::broadcast_node<message> to_output_;
     tbb::concurrent_hash_map<level_id::hash_type, product_store_ptr> stores_;
-    std::atomic<std::size_t> msg_counter_{}; // Is this sufficient?  Probably not.
     std::atomic<std::size_t> calls_{};
     std::atomic<std::size_t> product_count_{};
   };
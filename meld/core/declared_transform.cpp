@@ -7,4 +7,11 @@ namespace meld {
   }
 
   declared_transform::~declared_transform() = default;
+
+  void declared_transform::send_placeholders_on_rejection() noexcept
+  {
+    send_placeholders_ = true;
+  }
+
+  bool declared_transform::sends_placeholders() const noexcept { return send_placeholders_; }
 }
@@ -6,6 +6,7 @@
 
 #include "meld/core/concepts.hpp"
 #include "meld/core/detail/port_names.hpp"
+#include "meld/core/end_of_message.hpp"
 #include "meld/core/fwd.hpp"
 #include "meld/core/message.hpp"
 #include "meld/core/products_consumer.hpp"
@@ -16,6 +17,7 @@
 #include "meld/model/algorithm_name.hpp"
 #include "meld/model/handle.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/model/product_key.hpp"
 #include "meld/model/product_store.hpp"
 #include "meld/model/qualified_name.hpp"
 
@@ -49,7 +51,18 @@ namespace meld {
     virtual tbb::flow::sender<message>& sender() = 0;
     virtual tbb::flow::sender<message>& to_output() = 0;
     virtual qualified_names output() const = 0;
+    virtual type_ids output_types() const = 0; // Ordered as the output names
     virtual std::size_t product_count() const = 0;
+
+    // Set when every consumer of the transform's products is guarded by all of the
+    // transform's predicates (see framework_graph::finalize).
+    void send_placeholders_on_rejection() noexcept;
+
+  protected:
+    bool sends_placeholders() const noexcept;
+
+  private:
+    bool send_placeholders_{false};
   };
 
   using declared_transform_ptr = std::unique_ptr<declared_transform>;
@@ -165,6 +178,7 @@ namespace meld {
       product_labels_{std::move(product_labels)},
       input_{std::move(input)},
       output_{std::move(output)},
+      output_keys_{to_product_keys(output_)},
       join_{make_join_or_none(g, std::make_index_sequence<N>{})},
       transform_{
         g, concurrency, [this, ft = std::move(f)](messages_t<N> const& messages, auto& output) {
@@ -180,10 +194,11 @@ namespace meld {
             accessor a;
             if (stores_.insert(a, store->id()->hash())) {
               auto result = call(ft, messages, std::make_index_sequence<N>{});
+              release_inputs(messages);
               ++calls_;
               ++product_count_[store->id()->level_hash()];
-              products new_products;
-              new_products.add_all(output_, std::move(result));
+              products new_products{store->arena()};
+              new_products.add_all(output_keys_, std::move(result));
               a->second = store->make_continuation(this->full_name(), std::move(new_products));
 
               message const new_msg{a->second, msg.eom, message_id};
@@ -223,9 +238,36 @@ namespace meld {
     std::vector<tbb::flow::receiver<message>*> ports() override { return input_ports<N>(join_); }
 
     tbb::flow::sender<message>& sender() override { return output_port<0>(transform_); }
+
+    void reject(std::size_t const msg_id, filter_decision const& decision) override
+    {
+      auto const hash = decision.store_hash();
+      flag_for(hash).mark_as_processed();
+      if (done_with(hash)) {
+        stores_.erase(hash);
+      }
+      if (sends_placeholders()) {
+        // A message without a store stands in for the products that were not created, so
+        // that the downstream filters (which also reject the message) can complete.
+        output_port<0>(transform_).try_put({nullptr, decision.eom, msg_id});
+      }
+    }
     tbb::flow::sender<message>& to_output() override { return output_port<1>(transform_); }
     specified_labels input() const override { return product_labels_; }
+    type_ids input_types() const override { return detail::port_types(input_); }
     qualified_names output() const override { return output_; }
+    type_ids output_types() const override
+    {
+      using result_t = return_type<function_t>;
+      if constexpr (M == 1ull) {
+        return {type_id_for<result_t>()};
+      }
+      else {
+        return []<std::size_t... Is>(std::index_sequence<Is...>) {
+          return type_ids{type_id_for<std::tuple_element_t<Is, result_t>>()...};
+        }(std::make_index_sequence<M>{});
+      }
+    }
 
     template <std::size_t... Is>
     auto call(function_t const& ft, messages_t<N> const& messages, std::index_sequence<Is...>)
@@ -246,6 +288,7 @@ namespace meld {
     std::array<specified_label, N> product_labels_;
     InputArgs input_;
     std::array<qualified_name, M> output_;
+    std::array<product_key, M> output_keys_;
     join_or_none_t<N> join_;
     tbb::flow::multifunction_node<messages_t<N>, messages_t<2u>> transform_;
     stores_t stores_;
@@ -1,95 +1,148 @@
 #include "meld/core/detail/filter_impl.hpp"
+#include "meld/core/end_of_message.hpp"
 
-#include <string>
+#include <utility>
 
 namespace {
-  meld::specified_label const output_dummy{
-    meld::qualified_name{meld::algorithm_name{"for_output_only", ""}, "for_output_only"}};
-  std::vector<meld::specified_label> const for_output_only{output_dummy};
+  // States of each input argument of a filter record.  An argument's store is released
+  // exactly once--by whichever thread first sees both that the store has been filled and
+  // that the message has been rejected.
+  enum argument_state : std::uint8_t { empty, claimed, filled, released };
 }
 
 namespace meld {
-  decision_map::decision_map(unsigned int total_decisions) : total_decisions_{total_decisions} {}
-
-  void decision_map::update(predicate_result result)
+  level_id::hash_type filter_decision::store_hash() const
   {
-    decltype(results_)::accessor a;
-    results_.insert(a, result.msg_id);
-
-    // First check that the decision is not already complete
-    if (is_complete(a->second)) {
-      return;
+    // Ties go to the later store, as with 'most_derived' on the accepted path
+    product_store const* most_derived{nullptr};
+    for (auto const& store : stores) {
+      if (store and (not most_derived or store->id()->depth() >= most_derived->id()->depth())) {
+        most_derived = store.get();
+      }
     }
+    return most_derived ? most_derived->id()->hash() : eom->id()->hash();
+  }
 
-    if (not result.result) {
-      a->second = false_value;
-      return;
+  namespace detail {
+    filter_record::filter_record(std::size_t const nargs) : states(nargs), stores(nargs) {}
+
+    void filter_record::reset()
+    {
+      received.store(0ull, std::memory_order_relaxed);
+      rejected.store(false, std::memory_order_relaxed);
+      for (auto& state : states) {
+        state.store(empty, std::memory_order_relaxed);
+      }
+      for (auto& store : stores) {
+        store.reset();
+      }
+      eom.reset();
+      rejection_eom.reset();
     }
+  }
 
-    ++a->second;
-
-    if (a->second == total_decisions_) {
-      a->second = true_value;
-    }
+  // Output nodes do not take individual data products; the single store they receive is
+  // forwarded without checking its contents.
+  filter_records::filter_records(std::size_t const total_decisions,
+                                 for_output_t,
+                                 release_t release) :
+    release_{std::move(release)},
+    nargs_{1ull},
+    total_{total_decisions + nargs_},
+    records_{nargs_}
+  {
   }
 
-  unsigned int decision_map::value(std::size_t const msg_id) const
+  filter_records::filter_records(std::size_t const total_decisions,
+                                 specified_labels const product_names,
+                                 release_t release) :
+    release_{std::move(release)},
+    nargs_{product_names.size()},
+    total_{total_decisions + nargs_},
+    records_{nargs_}
   {
-    decltype(results_)::const_accessor a;
-    if (results_.find(a, msg_id)) {
-      return a->second;
+    product_keys_.reserve(nargs_);
+    for (auto const& label : product_names) {
+      product_keys_.emplace_back(label.name.name());
     }
-    return 0u;
   }
 
-  void decision_map::erase(std::size_t const msg_id) { results_.erase(msg_id); }
-
-  data_map::data_map(specified_labels const product_names) :
-    product_names_{product_names}, nargs_{product_names_.size()}
+  std::optional<filter_decision> filter_records::vote(predicate_result const& result)
   {
+    std::optional<filter_decision> decision;
+    records_.update(result.msg_id, [this, &result, &decision](detail::filter_record& r) {
+      if (not result.result and not r.rejected.exchange(true)) {
+        // First rejection: the stores that have arrived so far are no longer needed.
+        r.rejection_eom = result.eom;
+        release_filled(r);
+      }
+      return complete(r, decision);
+    });
+    return decision;
   }
 
-  data_map::data_map(for_output_t) : data_map{for_output_only} {}
+  std::optional<filter_decision> filter_records::add_data(message const& msg)
+  {
+    // The downstream node receives one message per input argument, but a store may
+    // provide the products of several arguments.  Each argument's slot is filled by the
+    // first store that provides its product.  A message without a store stands in for
+    // the output of an upstream node that did not run for the message (see
+    // products_consumer::reject); it is counted but provides no products.
+    std::optional<filter_decision> decision;
+    records_.update(msg.id, [this, &msg, &decision](detail::filter_record& r) {
+      bool filled_any{false};
+      for (std::size_t i = 0; msg.store and i != nargs_; ++i) {
+        if (nargs_ > 1ull and not msg.store->contains_product(product_keys_[i])) {
+          continue;
+        }
+        auto expected = static_cast<std::uint8_t>(empty);
+        if (not r.states[i].compare_exchange_strong(
+              expected, claimed, std::memory_order_relaxed)) {
+          continue;
+        }
+        r.stores[i] = msg.store;
+        if (i == 0ull) {
+          r.eom = msg.eom;
+        }
+        r.states[i].store(filled);
+        filled_any = true;
+      }
+      if (filled_any and r.rejected.load()) {
+        release_filled(r);
+      }
+      return complete(r, decision);
+    });
+    return decision;
+  }
 
-  void data_map::update(std::size_t const msg_id, product_store_const_ptr const& store)
+  bool filter_records::complete(detail::filter_record& r,
+                                std::optional<filter_decision>& decision) const
   {
-    decltype(stores_)::accessor a;
-    if (stores_.insert(a, msg_id)) {
-      a->second = std::vector<product_store_const_ptr>(nargs_);
+    if (r.received.fetch_add(1ull, std::memory_order_acq_rel) + 1ull != total_) {
+      return false;
     }
-    auto& elem = a->second;
-    if (nargs_ == 1ull) {
-      // We do not check that the product is in the store if only one argument is
-      // forwarded.  This enables us to forward arguments for regular nodes and also
-      // output nodes, which do not take individual data products.
-      elem[0] = store;
-      return;
-    }
-
-    // Fill slots in the order of the input arguments to the downstream node.
-    for (std::size_t i = 0; i != nargs_; ++i) {
-      if (elem[i] or not store->contains_product(product_names_[i].name.full()))
-        continue;
-      elem[i] = store;
+    bool const accepted = not r.rejected.load(std::memory_order_relaxed);
+    decision.emplace(accepted, std::move(accepted ? r.eom : r.rejection_eom));
+    for (auto& store : r.stores) {
+      decision->stores.push_back(std::move(store));
     }
+    return true;
   }
 
-  bool data_map::is_complete(std::size_t const msg_id) const
+  void filter_records::release_filled(detail::filter_record& r) const
   {
-    decltype(stores_)::const_accessor a;
-    if (stores_.find(a, msg_id)) {
-      return a->second.size() == nargs_;
+    for (std::size_t i = 0; i != nargs_; ++i) {
+      auto expected = static_cast<std::uint8_t>(filled);
+      if (r.states[i].compare_exchange_strong(expected, released)) {
+        release(i, r.stores[i]);
+      }
     }
-    return false;
   }
 
-  std::vector<product_store_const_ptr> data_map::release_data(accessor& a, std::size_t const msg_id)
+  void filter_records::release(std::size_t const index, product_store_const_ptr const& store) const
   {
-    std::vector<product_store_const_ptr> result;
-    if (stores_.find(a, msg_id)) {
-      result = std::move(a->second);
-      stores_.erase(a);
+    if (release_) {
+      release_(index, store);
     }
-    return result;
   }
 }
@@ -1,16 +1,38 @@
 #ifndef meld_core_detail_filter_impl_hpp
 #define meld_core_detail_filter_impl_hpp
 
+// =======================================================================================
+// A filter collects, for each message ID, the votes of the predicates that guard the
+// downstream node and the stores that provide the node's input products.  Both are kept
+// in a single filter_record, and the records are held in a slot_table (see
+// slot_table.hpp), so that neither votes nor data require any locks.  Once every
+// predicate has voted and every input has arrived, exactly one filter_decision is
+// produced for the message ID.
+//
+// A rejection is acted upon as soon as the first predicate votes against the message:
+// the input stores that have already arrived, and those that arrive afterward, are
+// handed to the records' release function instead of being held until the remaining
+// votes are in.  The rejected message is decided only once every input has been
+// received, so that the decision names the same stores as an acceptance would (see
+// filter_decision::store_hash).  Inputs from upstream nodes that did not run for the
+// message arrive as placeholder messages (see products_consumer::reject), so every
+// record is eventually completed and its slot freed.
+// =======================================================================================
+
+#include "meld/core/detail/slot_table.hpp"
 #include "meld/core/message.hpp"
 #include "meld/core/specified_label.hpp"
-#include "meld/model/level_id.hpp"
+#include "meld/model/product_key.hpp"
 #include "meld/model/product_store.hpp"
 
-#include "oneapi/tbb/concurrent_hash_map.h"
-#include "oneapi/tbb/flow_graph.h"
+#include "boost/container/small_vector.hpp"
 
-#include <cassert>
-#include <span>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
 
 namespace meld {
   struct predicate_result {
@@ -19,54 +41,62 @@ namespace meld {
     bool result;
   };
 
-  inline constexpr unsigned int true_value{-1u};
-  inline constexpr unsigned int false_value{-2u};
-
-  constexpr bool is_complete(unsigned int value)
-  {
-    return value == true_value or value == false_value;
-  }
-
-  constexpr bool to_boolean(unsigned int value)
-  {
-    assert(is_complete(value));
-    return value == true_value;
-  }
-
-  class decision_map {
-  public:
-    explicit decision_map(unsigned int total_decisions);
-
-    void update(predicate_result result);
-    unsigned int value(std::size_t msg_id) const;
-    void erase(std::size_t msg_id);
-
-  private:
-    unsigned int const total_decisions_;
-    oneapi::tbb::concurrent_hash_map<std::size_t, unsigned int> results_;
+  struct filter_decision {
+    bool accepted;
+    end_of_message_ptr eom;
+    // Ordered as the input arguments of the downstream node; for a rejected message, the
+    // stores' products have already been released, and placeholder inputs are null.
+    boost::container::small_vector<product_store_const_ptr, 4> stores;
+
+    // Hash of the ID of the most derived input store--the store whose level instance the
+    // downstream node processes.  If no input provided a store, the message's own level
+    // instance is used.
+    level_id::hash_type store_hash() const;
   };
 
-  class data_map {
-    using stores_t =
-      oneapi::tbb::concurrent_hash_map<std::size_t, std::vector<product_store_const_ptr>>;
+  namespace detail {
+    struct filter_record {
+      explicit filter_record(std::size_t nargs);
+      void reset();
+
+      std::atomic<std::size_t> received{}; // Number of votes and data messages
+      std::atomic<bool> rejected{};
+      std::vector<std::atomic<std::uint8_t>> states; // See filter_impl.cpp
+      std::vector<product_store_const_ptr> stores;
+      end_of_message_ptr eom;           // From the store of the first argument
+      end_of_message_ptr rejection_eom; // From the first vote against the message
+    };
+  }
 
+  class filter_records {
   public:
-    using accessor = stores_t::accessor;
-
     struct for_output_t {};
     static constexpr for_output_t for_output{};
-    explicit data_map(for_output_t);
-    explicit data_map(specified_labels product_names);
+    // Called with the argument index of each input store that will not be forwarded
+    using release_t = std::function<void(std::size_t, product_store_const_ptr const&)>;
+
+    filter_records(std::size_t total_decisions, for_output_t, release_t release = {});
+    filter_records(std::size_t total_decisions,
+                   specified_labels product_names,
+                   release_t release = {});
 
-    bool is_complete(std::size_t const msg_id) const;
+    // Each call returns the decision for the message ID if it completed the record.
+    std::optional<filter_decision> vote(predicate_result const& result);
+    std::optional<filter_decision> add_data(message const& msg);
 
-    void update(std::size_t const msg_id, product_store_const_ptr const& store);
-    std::vector<product_store_const_ptr> release_data(accessor& a, std::size_t const msg_id);
+    std::size_t overflow_size() const { return records_.overflow_size(); }
 
   private:
-    stores_t stores_;
-    specified_labels product_names_;
+    // Counts a vote or data message; returns true if the record is complete.
+    bool complete(detail::filter_record& record, std::optional<filter_decision>& decision) const;
+    void release_filled(detail::filter_record& record) const;
+    void release(std::size_t index, product_store_const_ptr const& store) const;
+
+    std::vector<product_key> product_keys_;
+    release_t release_;
     std::size_t nargs_;
+    std::size_t total_;
+    detail::slot_table<detail::filter_record> records_;
   };
 }
 
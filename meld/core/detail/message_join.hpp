@@ -0,0 +1,98 @@
+#ifndef meld_core_detail_message_join_hpp
+#define meld_core_detail_message_join_hpp
+
+// =======================================================================================
+// A message_join combines N messages that carry the same message ID--one per input
+// port--into a messages_t<N> tuple, which is then broadcast to the join's successors.
+// It replaces TBB's tag-matching join_node, whose ports each hold their own buffers and
+// locks.  Pending messages are kept in a slot_table (see slot_table.hpp); the last
+// message to arrive for an ID fires the join.
+// =======================================================================================
+
+#include "meld/core/detail/slot_table.hpp"
+#include "meld/utilities/sized_tuple.hpp"
+
+#include "oneapi/tbb/flow_graph.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace meld::detail {
+  template <std::size_t N, typename Message>
+  class message_join : public tbb::flow::broadcast_node<sized_tuple<Message, N>> {
+    using messages_type = sized_tuple<Message, N>;
+    using base = tbb::flow::broadcast_node<messages_type>;
+    using port_base =
+      tbb::flow::function_node<Message, tbb::flow::continue_msg, tbb::flow::lightweight>;
+
+    template <std::size_t I>
+    class port : public port_base {
+    public:
+      explicit port(message_join& join) :
+        port_base{join.graph_, tbb::flow::unlimited, [&join](Message const& msg) {
+                    join.template arrive<I>(msg);
+                    return tbb::flow::continue_msg{};
+                  }}
+      {
+      }
+    };
+
+    template <std::size_t... Is>
+    static std::tuple<port<Is>...> ports_for(std::index_sequence<Is...>);
+
+  public:
+    using input_ports_type = decltype(ports_for(std::make_index_sequence<N>{}));
+
+    static constexpr std::size_t slot_count{slot_table_size};
+
+    explicit message_join(tbb::flow::graph& g) : message_join{g, std::make_index_sequence<N>{}}
+    {
+    }
+
+    input_ports_type& input_ports() noexcept { return ports_; }
+
+    // Number of message IDs currently held in the overflow map
+    std::size_t overflow_size() const { return pending_.overflow_size(); }
+
+  private:
+    template <std::size_t... Is>
+    message_join(tbb::flow::graph& g, std::index_sequence<Is...>) :
+      base{g}, graph_{g}, ports_{type_t<message_join&, Is>(*this)...}
+    {
+    }
+
+    struct record {
+      std::atomic<std::size_t> arrived{};
+      std::array<Message, N> messages{};
+      void reset() { arrived.store(0ull, std::memory_order_relaxed); }
+    };
+
+    template <std::size_t I>
+    void arrive(Message const& msg)
+    {
+      messages_type result;
+      auto const complete = pending_.update(msg.id, [&msg, &result](record& r) {
+        r.messages[I] = msg;
+        if (r.arrived.fetch_add(1ull, std::memory_order_acq_rel) + 1ull != N) {
+          return false;
+        }
+        result = [&r]<std::size_t... Is>(std::index_sequence<Is...>) {
+          return messages_type{std::move(r.messages[Is])...};
+        }(std::make_index_sequence<N>{});
+        return true;
+      });
+      if (complete) {
+        this->try_put(result);
+      }
+    }
+
+    tbb::flow::graph& graph_;
+    input_ports_type ports_;
+    slot_table<record> pending_;
+  };
+}
+
+#endif // meld_core_detail_message_join_hpp
@@ -3,6 +3,7 @@
 
 #include "meld/core/input_arguments.hpp"
 #include "meld/core/specified_label.hpp"
+#include "meld/model/type_id.hpp"
 
 #include <array>
 #include <cstdint>
@@ -19,6 +20,16 @@ namespace meld::detail {
     };
     return unpack(args, std::make_index_sequence<N>{});
   }
+
+  template <typename InputArgs>
+  type_ids port_types(InputArgs const& args)
+  {
+    constexpr auto N = std::tuple_size_v<InputArgs>;
+    auto unpack = []<std::size_t... Is>(InputArgs const& inputs, std::index_sequence<Is...>) {
+      return type_ids{std::get<Is>(inputs).type()...};
+    };
+    return unpack(args, std::make_index_sequence<N>{});
+  }
 }
 
 #endif // meld_core_detail_port_names_hpp
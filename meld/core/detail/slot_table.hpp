@@ -0,0 +1,182 @@
+#ifndef meld_core_detail_slot_table_hpp
+#define meld_core_detail_slot_table_hpp
+
+// =======================================================================================
+// A slot_table holds one record per message ID for as long as the record is being filled
+// (e.g. until all inputs of a join have arrived).  Records are kept in a pre-sized table
+// of slots indexed by a hash of the message ID (see slot_index).  The first update for an
+// ID claims the slot (with a single compare-and-swap), and the update that completes the
+// record resets it and releases the slot.  None of these steps takes a lock; the records
+// themselves must therefore support concurrent updates.
+//
+// If a slot is already claimed by a different message ID, the slot is marked as having
+// overflowed, and the record is kept in an overflow map that is protected by a mutex.
+// Until the overflowing records for a slot have been completed, all updates for IDs that
+// map to that slot are made under the mutex.  This guarantees that all updates for a
+// given ID are applied to the same record.
+// =======================================================================================
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace meld::detail {
+  // Number of slots in each table; must be a power of two
+  inline constexpr std::size_t slot_table_size{256};
+
+  // Message IDs are handed out in per-thread blocks (see next_message_id), so the IDs in
+  // flight at the same time are offset by multiples of the block size.  The bits of an ID
+  // are therefore mixed (Fibonacci hashing) before the ID is reduced to a slot.
+  constexpr std::size_t slot_index(std::size_t const id) noexcept
+  {
+    return (id * 0x9e3779b97f4a7c15ull) >> (64 - std::countr_zero(slot_table_size));
+  }
+
+  template <typename Record>
+  class slot_table {
+  public:
+    static constexpr std::size_t slot_count{slot_table_size};
+
+    // Each record is constructed with the specified arguments.
+    template <typename... Args>
+    explicit slot_table(Args const&... args) :
+      make_overflow_record_{[args...] { return std::make_unique<Record>(args...); }}
+    {
+      for (std::size_t i = 0; i != slot_count; ++i) {
+        slots_.emplace_back(args...);
+      }
+    }
+
+    // Applies 'update' to the record for the specified ID.  The update must return true
+    // if it completed the record, which is then reset (see Record::reset) and released.
+    // Only one update per record may return true.  The return value of the update is
+    // returned.
+    template <typename F>
+    bool update(std::size_t const id, F&& update)
+    {
+      auto const index = slot_index(id);
+      auto& s = slots_[index];
+      auto const owned = owned_by(id);
+      auto state = s.state.load(std::memory_order_acquire);
+      while (true) {
+        if ((state & owner_mask) == owned) {
+          return update_slot(s, update);
+        }
+        if (state & overflow_bit) {
+          return update_overflow(index, id, update);
+        }
+        if (state == 0ull) {
+          if (s.state.compare_exchange_weak(state, owned, std::memory_order_acq_rel)) {
+            return update_slot(s, update);
+          }
+          continue;
+        }
+        // Slot is owned by another message ID
+        if (s.state.compare_exchange_weak(
+              state, state | overflow_bit, std::memory_order_acq_rel)) {
+          return update_overflow(index, id, update);
+        }
+      }
+    }
+
+    // Number of records currently held in the overflow map
+    std::size_t overflow_size() const
+    {
+      std::lock_guard lock{overflow_mutex_};
+      return overflow_.size();
+    }
+
+  private:
+    // The state of a slot encodes the ID that owns it (offset by one, so that zero means
+    // unowned) and, in the lowest bit, whether any record for an ID that maps to the slot
+    // is held in the overflow map.
+    static constexpr std::uint64_t overflow_bit{1ull};
+    static constexpr std::uint64_t owner_mask{~overflow_bit};
+    static std::uint64_t owned_by(std::size_t const id) noexcept { return (id + 1ull) << 1; }
+
+    struct slot {
+      template <typename... Args>
+      explicit slot(Args const&... args) : record{args...}
+      {
+      }
+      std::atomic<std::uint64_t> state{};
+      Record record;
+    };
+
+    template <typename F>
+    static bool update_slot(slot& s, F& update)
+    {
+      if (not update(s.record)) {
+        return false;
+      }
+      s.record.reset();
+      // Release the slot, but retain the overflow flag
+      s.state.fetch_and(overflow_bit, std::memory_order_release);
+      return true;
+    }
+
+    template <typename F>
+    bool update_overflow(std::size_t const index, std::size_t const id, F& update)
+    {
+      auto& s = slots_[index];
+      auto const owned = owned_by(id);
+
+      std::unique_lock lock{overflow_mutex_};
+      auto& overflow_count = overflow_counts_[index];
+      auto it = overflow_.find(id);
+      if (it == overflow_.end()) {
+        // The overflow flag is only needed while the map holds records for the slot.
+        auto const flag = overflow_count == 0ull ? 0ull : overflow_bit;
+        auto state = s.state.load(std::memory_order_acquire);
+        while (true) {
+          if ((state & owner_mask) == owned) {
+            if (flag == 0ull) {
+              s.state.fetch_and(owner_mask, std::memory_order_release);
+            }
+            lock.unlock();
+            return update_slot(s, update);
+          }
+          if ((state & owner_mask) == 0ull) {
+            if (s.state.compare_exchange_weak(state, owned | flag, std::memory_order_acq_rel)) {
+              lock.unlock();
+              return update_slot(s, update);
+            }
+            continue;
+          }
+          if ((state & overflow_bit) == 0ull and
+              not s.state.compare_exchange_weak(
+                state, state | overflow_bit, std::memory_order_acq_rel)) {
+            continue;
+          }
+          break;
+        }
+        it = overflow_.emplace(id, make_overflow_record_()).first;
+        ++overflow_count;
+      }
+
+      if (not update(*it->second)) {
+        return false;
+      }
+      overflow_.erase(it);
+      if (--overflow_count == 0ull) {
+        s.state.fetch_and(owner_mask, std::memory_order_release);
+      }
+      return true;
+    }
+
+    std::deque<slot> slots_;
+    std::function<std::unique_ptr<Record>()> make_overflow_record_;
+    mutable std::mutex overflow_mutex_;
+    std::unordered_map<std::size_t, std::unique_ptr<Record>> overflow_;
+    std::vector<std::size_t> overflow_counts_ = std::vector<std::size_t>(slot_count);
+  };
+}
+
+#endif // meld_core_detail_slot_table_hpp
@@ -3,9 +3,11 @@
 
 #include "meld/core/message.hpp"
 #include "meld/model/qualified_name.hpp"
+#include "meld/model/type_id.hpp"
 
 #include "oneapi/tbb/flow_graph.h"
 
+#include <cstddef>
 #include <map>
 #include <ranges>
 #include <string>
@@ -22,6 +24,7 @@ namespace meld {
       algorithm_name node;
       tbb::flow::sender<message>* port;
       tbb::flow::sender<message>* to_output;
+      type_id type;
     };
 
     named_output_port const* find_producer(qualified_name const& product_name) const;
@@ -42,11 +45,13 @@ namespace meld {
   {
     std::multimap<product_name_t, named_output_port> result;
     for (auto const& [node_name, node] : nodes) {
-      for (auto const& product_name : node->output()) {
+      auto const types = node->output_types();
+      for (std::size_t i = 0; auto const& product_name : node->output()) {
+        auto const type = types[i++];
         if (empty(product_name.name()))
           continue;
         result.emplace(product_name.name(),
-                       named_output_port{node_name, &node->sender(), &node->to_output()});
+                       named_output_port{node_name, &node->sender(), &node->to_output(), type});
       }
     }
     return result;
@@ -1,6 +1,7 @@
 #ifndef meld_core_edge_maker_hpp
 #define meld_core_edge_maker_hpp
 
+#include "meld/core/consumer_counts.hpp"
 #include "meld/core/declared_output.hpp"
 #include "meld/core/declared_splitter.hpp"
 #include "meld/core/dot/attributes.hpp"
@@ -10,14 +11,20 @@
 #include "meld/core/filter.hpp"
 #include "meld/core/multiplexer.hpp"
 
+#include "fmt/format.h"
 #include "oneapi/tbb/flow_graph.h"
 
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <ranges>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -48,7 +55,7 @@ namespace meld {
     edge_maker(std::string const& file_prefix, Args&... args);
 
     template <typename... Args>
-    void operator()(tbb::flow::input_node<message>& source,
+    void operator()(tbb::flow::sender<message>& source,
                     multiplexer& multi,
                     std::map<std::string, filter>& filters,
                     declared_outputs& outputs,
@@ -80,7 +87,16 @@ namespace meld {
       auto const& node_name = node->full_name();
       function_graph_->node(node_name, node_attributes);
       for (auto const& predicate_name : node->when()) {
-        function_graph_->edge(predicate_name, node_name, {.color = "red"});
+        dot::attributes attrs{.color = "red"};
+        if (auto it = node->added_predicates().find(predicate_name);
+            it != node->added_predicates().end()) {
+          // Predicates added by the framework are drawn with dashed lines.
+          attrs.fontcolor = "red";
+          attrs.fontsize = dot::default_fontsize;
+          attrs.label = dot::parenthesized(it->second);
+          attrs.style = "dashed";
+        }
+        function_graph_->edge(predicate_name, node_name, attrs);
       }
 
       if constexpr (supports_output<decltype(node)>) {
@@ -139,7 +155,9 @@ namespace meld {
 
       make_the_node(node, attributes);
 
-      for (auto const& product_label : node->input()) {
+      auto const types = node->input_types();
+      for (std::size_t i = 0; auto const& product_label : node->input()) {
+        auto const type = types[i++];
         auto* receiver_port = collector ? collector : &node->port(product_label);
         auto producer = producers_.find_producer(product_label.name);
         if (not producer) {
@@ -148,6 +166,19 @@ namespace meld {
           continue;
         }
 
+        // Type mismatches between nodes are reported when the graph is finalized, instead
+        // of when the product is first accessed.
+        if (producer->type != type) {
+          throw std::runtime_error(fmt::format(
+            "Node '{}' requires product '{}' with type '{}', but node '{}' creates it with "
+            "type '{}'.",
+            node_name,
+            product_label.to_string(),
+            type.name(),
+            producer->node.full(),
+            producer->type.name()));
+        }
+
         make_the_edge(*producer, *receiver_port, node_name, to_name(product_label));
       }
     }
@@ -155,7 +186,7 @@ namespace meld {
   }
 
   template <typename... Args>
-  void edge_maker::operator()(tbb::flow::input_node<message>& source,
+  void edge_maker::operator()(tbb::flow::sender<message>& source,
                               multiplexer& multi,
                               std::map<std::string, filter>& filters,
                               declared_outputs& outputs,
@@ -204,6 +235,90 @@ namespace meld {
     std::map<std::string, std::vector<std::string>> consumed_products;
     (get_consumed_products(cons, consumed_products), ...);
 
+    // Products are released as soon as all of their consumers have used them, unless an
+    // output node requires that they be retained.
+    bool const retain_products = std::ranges::any_of(
+      outputs | std::views::values, [](auto const& output) { return output->retains_products(); });
+    consumer_counts counts{};
+    if (not retain_products) {
+      std::map<std::string, std::size_t> consumers_per_product;
+      for (auto const& [product_name, node_names] : consumed_products) {
+        consumers_per_product.emplace(product_name, node_names.size());
+      }
+      counts = consumer_counts{consumers_per_product, outputs.size()};
+    }
+    auto set_consumer_counts = [&counts](auto const& cons) {
+      for (auto const& consumer : cons.data | std::views::values) {
+        consumer->set_consumer_counts(counts);
+      }
+    };
+    (set_consumer_counts(cons), ...);
+    for (auto const& output : outputs | std::views::values) {
+      output->set_consumer_counts(counts);
+    }
+
+    // A splitter is downstream of another splitter if it consumes a product that is derived
+    // from the products of the other splitter's children.  The children of a splitter with
+    // downstream splitters are therefore unfolded further.
+    struct product_flow {
+      std::string name;
+      std::vector<std::string> inputs;
+      std::vector<std::string> outputs;
+      bool unfolds;
+    };
+    std::vector<product_flow> flows;
+    auto record_flows = [&flows](auto const& cons) {
+      constexpr bool unfolds =
+        std::same_as<std::remove_cvref_t<decltype(cons)>, consumers<declared_splitters>>;
+      for (auto const& [node_name, node] : cons.data) {
+        if constexpr (supports_output<decltype(node)>) {
+          product_flow flow{node_name, {}, {}, unfolds};
+          for (auto const& product_name : node->input() | std::views::transform(to_name)) {
+            flow.inputs.push_back(product_name);
+          }
+          for (auto const& product_name : node->output()) {
+            flow.outputs.push_back(product_name.name());
+          }
+          flows.push_back(std::move(flow));
+        }
+      }
+    };
+    (record_flows(cons), ...);
+
+    auto downstream_splitters = [&flows](declared_splitter const& splitter) {
+      std::set<std::string> result;
+      std::set<std::string> derived;
+      for (auto const& product_name : splitter.output()) {
+        derived.insert(product_name.name());
+      }
+      std::vector<bool> visited(flows.size());
+      for (bool changed = true; changed;) {
+        changed = false;
+        for (std::size_t i = 0; auto const& flow : flows) {
+          auto const index = i++;
+          if (visited[index] or
+              std::ranges::none_of(flow.inputs, [&derived](auto const& product_name) {
+                return derived.contains(product_name);
+              })) {
+            continue;
+          }
+          if (flow.unfolds) {
+            result.insert(flow.name);
+          }
+          visited[index] = true;
+          derived.insert(begin(flow.outputs), end(flow.outputs));
+          changed = true;
+        }
+      }
+      return result;
+    };
+
+    for (auto const& [name, splitter] : splitters.data) {
+      if (not empty(downstream_splitters(*splitter))) {
+        splitter->retain_children_products();
+      }
+    }
+
     std::set<std::string> remove_ports_for_products;
     for (auto const& [name, splitter] : splitters.data) {
       multiplexer::head_ports_t heads;
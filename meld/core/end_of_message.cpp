@@ -1,8 +1,130 @@
 #include "meld/core/end_of_message.hpp"
+#include "meld/core/event_window.hpp"
 #include "meld/model/level_hierarchy.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+  // Memory of destroyed end-of-message objects is cached by the destroying thread for reuse
+  // by the next object it allocates.  Objects are often allocated by one thread and
+  // destroyed by another, so memory is moved between the per-thread caches in batches
+  // through a depot that is shared by all threads.
+  constexpr std::size_t batch_size{128};
+
+  // The depot is never destroyed, so that it outlives all threads.
+  class eom_depot {
+  public:
+    // Memory is reserved up front so that freeing objects never allocates.
+    eom_depot() { free_.reserve(max_size); }
+
+    // Returns false if the depot is full and the batch was not taken.
+    bool put(void* const* batch)
+    {
+      std::lock_guard lock{mutex_};
+      if (size(free_) == max_size) {
+        return false;
+      }
+      free_.insert(free_.end(), batch, batch + batch_size);
+      return true;
+    }
+
+    // Returns false if the depot has no batch to hand out.
+    bool take(void** batch)
+    {
+      std::lock_guard lock{mutex_};
+      if (empty(free_)) {
+        return false;
+      }
+      auto const begin = free_.end() - batch_size;
+      std::copy(begin, free_.end(), batch);
+      free_.erase(begin, free_.end());
+      return true;
+    }
+
+  private:
+    static constexpr std::size_t max_size{64 * batch_size};
+    std::mutex mutex_;
+    std::vector<void*> free_;
+  };
+
+  eom_depot& depot()
+  {
+    static auto* const result = new eom_depot;
+    return *result;
+  }
+
+  // The cache is trivially destructible and thus usable until its thread ends, even by
+  // thread-local objects that are destroyed after the cache has been closed.
+  struct eom_cache {
+    std::array<void*, 2 * batch_size> free;
+    std::size_t size;
+    bool closed;
+  };
+  constinit thread_local eom_cache cache{};
+
+  // Hands the cached memory to the depot (or frees it) once the thread begins to exit;
+  // memory is no longer cached by the thread after that.
+  struct eom_cache_closer {
+    ~eom_cache_closer()
+    {
+      while (cache.size >= batch_size and
+             depot().put(cache.free.data() + cache.size - batch_size)) {
+        cache.size -= batch_size;
+      }
+      for (std::size_t i = 0; i != cache.size; ++i) {
+        ::operator delete(cache.free[i]);
+      }
+      cache.size = 0;
+      cache.closed = true;
+    }
+    void register_thread() const noexcept {}
+  };
+  thread_local eom_cache_closer closer;
+
+  void* allocate(std::size_t const bytes)
+  {
+    if (cache.size == 0) {
+      if (cache.closed or not depot().take(cache.free.data())) {
+        return ::operator new(bytes);
+      }
+      closer.register_thread();
+      cache.size = batch_size;
+    }
+    return cache.free[--cache.size];
+  }
+
+  void deallocate(void* p) noexcept
+  {
+    if (cache.closed) {
+      ::operator delete(p);
+      return;
+    }
+    if (cache.size == cache.free.size()) {
+      // Half of the cache is made available to other threads.
+      if (not depot().put(cache.free.data() + batch_size)) {
+        ::operator delete(p);
+        return;
+      }
+      cache.size -= batch_size;
+    }
+    if (cache.size == 0) {
+      closer.register_thread();
+    }
+    cache.free[cache.size++] = p;
+  }
+}
+
 namespace meld {
 
+  void* end_of_message::operator new(std::size_t const bytes) { return allocate(bytes); }
+
+  void end_of_message::operator delete(void* p) noexcept { deallocate(p); }
+
   end_of_message::end_of_message(end_of_message_ptr parent,
                                  level_hierarchy* hierarchy,
                                  level_id_ptr id) :
@@ -17,7 +139,28 @@ namespace meld {
 
   end_of_message_ptr end_of_message::make_child(level_id_ptr id)
   {
-    return end_of_message_ptr{new end_of_message{shared_from_this(), hierarchy_, id}};
+    return end_of_message_ptr{new end_of_message{end_of_message_ptr{this}, hierarchy_, id}};
+  }
+
+  void intrusive_ptr_add_ref(end_of_message const* eom) noexcept
+  {
+    eom->use_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void intrusive_ptr_release(end_of_message const* eom) noexcept
+  {
+    if (eom->use_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete eom;
+    }
+  }
+
+  level_id_ptr const& end_of_message::id() const noexcept { return id_; }
+
+  void end_of_message::return_token_to(event_window& window) noexcept { window_ = &window; }
+
+  void end_of_message::on_release(std::function<void()> callback)
+  {
+    on_release_ = std::move(callback);
   }
 
   end_of_message::~end_of_message()
@@ -25,6 +168,12 @@ namespace meld {
     if (hierarchy_) {
       hierarchy_->increment_count(id_);
     }
+    if (window_) {
+      window_->release();
+    }
+    if (on_release_) {
+      on_release_();
+    }
   }
 
 }
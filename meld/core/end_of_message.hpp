@@ -4,22 +4,43 @@
 #include "meld/core/fwd.hpp"
 #include "meld/model/fwd.hpp"
 
-#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <functional>
 
 namespace meld {
 
-  class end_of_message : public std::enable_shared_from_this<end_of_message> {
+  class end_of_message final {
   public:
     static end_of_message_ptr make_base(level_hierarchy* hierarchy, level_id_ptr id);
     end_of_message_ptr make_child(level_id_ptr id);
     ~end_of_message();
 
+    // End-of-message objects are allocated from per-thread caches of freed objects.
+    static void* operator new(std::size_t bytes);
+    static void operator delete(void* p) noexcept;
+
+    level_id_ptr const& id() const noexcept;
+
+    // The token is returned to the window when this object is destroyed.
+    void return_token_to(event_window& window) noexcept;
+
+    // The callback is invoked when this object is destroyed.
+    void on_release(std::function<void()> callback);
+
   private:
+    friend void intrusive_ptr_add_ref(end_of_message const* eom) noexcept;
+    friend void intrusive_ptr_release(end_of_message const* eom) noexcept;
+
     end_of_message(end_of_message_ptr parent, level_hierarchy* hierarchy, level_id_ptr id);
 
+    mutable std::atomic<std::size_t> use_count_{};
+
     end_of_message_ptr parent_;
     level_hierarchy* hierarchy_;
     level_id_ptr id_;
+    event_window* window_{nullptr};
+    std::function<void()> on_release_{};
   };
 
 }
@@ -0,0 +1,110 @@
+#include "meld/core/event_window.hpp"
+#include "meld/core/end_of_message.hpp"
+#include "meld/model/product_store.hpp"
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace meld {
+  event_window::event_window(tbb::flow::graph& g,
+                             std::size_t const max_events,
+                             std::unique_ptr<memory_governor> governor) :
+    max_events_{max_events},
+    governor_{std::move(governor)},
+    limiter_{g, max_events},
+    admit_{g,
+           tbb::flow::unlimited,
+           [this](message const& msg) {
+             admit(msg);
+             return tbb::flow::continue_msg{};
+           }},
+    output_{g}
+  {
+    assert(max_events_ > 0ull);
+    make_edge(limiter_, admit_);
+  }
+
+  event_window::~event_window()
+  {
+    // Held messages may only be destroyed once tokens are no longer returned.
+    close();
+    held_.clear();
+  }
+
+  tbb::flow::receiver<message>& event_window::input() noexcept { return limiter_; }
+  tbb::flow::sender<message>& event_window::output() noexcept { return output_; }
+  std::size_t event_window::max_events() const noexcept { return max_events_; }
+  memory_governor const* event_window::governor() const noexcept { return governor_.get(); }
+
+  std::size_t event_window::held_events() const
+  {
+    std::lock_guard lock{mutex_};
+    return held_events_;
+  }
+
+  void event_window::admit(message const& msg)
+  {
+    assert(msg.store and msg.eom);
+    // The source enables early release only for stores that will not have children (see
+    // framework_graph.cpp).
+    if (not msg.store->early_release_enabled()) {
+      return_token();
+      output_.try_put(msg);
+      return;
+    }
+
+    msg.eom->return_token_to(*this);
+    if (governor_) {
+      std::lock_guard lock{mutex_};
+      if (running_ > 0ull and governor_->above_high_watermark()) {
+        held_.push_back(msg);
+        ++held_events_;
+        return;
+      }
+      ++running_;
+    }
+    output_.try_put(msg);
+  }
+
+  void event_window::release()
+  {
+    if (not open_.load(std::memory_order_acquire)) {
+      return;
+    }
+    return_token();
+    if (not governor_) {
+      return;
+    }
+
+    // Once the memory usage has dropped below the high watermark, all held events are
+    // processed; otherwise, one is processed only if no other event is.
+    std::vector<message> ready;
+    {
+      std::lock_guard lock{mutex_};
+      --running_;
+      if (not held_.empty()) {
+        auto const n_ready = governor_->above_high_watermark() ?
+                               static_cast<std::size_t>(running_ == 0ull) :
+                               held_.size();
+        for (std::size_t i = 0; i != n_ready; ++i) {
+          ready.push_back(std::move(held_.front()));
+          held_.pop_front();
+        }
+        running_ += n_ready;
+      }
+    }
+    for (auto const& msg : ready) {
+      output_.try_put(msg);
+    }
+  }
+
+  void event_window::return_token()
+  {
+    if (open_.load(std::memory_order_acquire)) {
+      limiter_.decrementer().try_put(tbb::flow::continue_msg{});
+    }
+  }
+
+  void event_window::close() noexcept { open_.store(false, std::memory_order_release); }
+}
@@ -0,0 +1,69 @@
+#ifndef meld_core_event_window_hpp
+#define meld_core_event_window_hpp
+
+// =======================================================================================
+// An event_window bounds the number of events--product stores without child stores--that
+// are in flight at any one time.  It sits between the framework's source node and the
+// nodes that receive the source's messages.  Each event message takes one token from the
+// window, and the token is returned when the event's end_of_message object is destroyed,
+// i.e. once the event and its flush have been processed by all nodes.  When no tokens are
+// left, the window refuses further messages, and the source stops reading stores until a
+// token is returned.  Messages for stores that have children do not keep a token.
+//
+// A window can also be given a memory governor.  While the governor reports that the
+// memory usage is above its high watermark, admitted events are held by the window
+// instead of being processed, unless no other event is being processed.  Held events
+// keep their tokens, so the source pauses once the window is full.
+// =======================================================================================
+
+#include "meld/core/memory_governor.hpp"
+#include "meld/core/message.hpp"
+
+#include "oneapi/tbb/flow_graph.h"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace meld {
+  class event_window {
+  public:
+    event_window(tbb::flow::graph& g,
+                 std::size_t max_events,
+                 std::unique_ptr<memory_governor> governor = nullptr);
+    ~event_window();
+
+    tbb::flow::receiver<message>& input() noexcept;
+    tbb::flow::sender<message>& output() noexcept;
+    std::size_t max_events() const noexcept;
+    memory_governor const* governor() const noexcept;
+
+    // Number of events that were held because of the memory governor
+    std::size_t held_events() const;
+
+    // Returns an event's token to the window
+    void release();
+
+    // After the graph has finished executing, returned tokens are ignored.
+    void close() noexcept;
+
+  private:
+    void admit(message const& msg);
+    void return_token();
+
+    std::size_t max_events_;
+    std::unique_ptr<memory_governor> governor_;
+    tbb::flow::limiter_node<message> limiter_;
+    tbb::flow::function_node<message, tbb::flow::continue_msg, tbb::flow::lightweight> admit_;
+    tbb::flow::broadcast_node<message> output_;
+    mutable std::mutex mutex_;
+    std::deque<message> held_;
+    std::size_t running_{};
+    std::size_t held_events_{};
+    std::atomic<bool> open_{true};
+  };
+}
+
+#endif // meld_core_event_window_hpp
@@ -4,18 +4,24 @@
 
 #include "oneapi/tbb/flow_graph.h"
 
+#include <optional>
+
 using namespace meld;
 using namespace oneapi::tbb;
 
 namespace meld {
   filter::filter(flow::graph& g, products_consumer& consumer) :
     filter_base{g},
-    decisions_{static_cast<unsigned int>(consumer.when().size())},
-    data_{consumer.input()},
+    records_{consumer.when().size(),
+             consumer.input(),
+             [&consumer](std::size_t const i, product_store_const_ptr const& store) {
+               consumer.release_input(i, store);
+             }},
     indexer_{g},
     filter_{g, flow::unlimited, [this](tag_t const& t) { return execute(t); }},
     downstream_ports_{consumer.ports()},
-    nargs_{size(downstream_ports_)}
+    nargs_{size(downstream_ports_)},
+    consumer_{&consumer}
   {
     make_edge(indexer_, filter_);
     set_external_ports(input_ports_type{input_port<0>(indexer_), input_port<1>(indexer_)},
@@ -24,8 +30,11 @@ namespace meld {
 
   filter::filter(flow::graph& g, declared_output& output) :
     filter_base{g},
-    decisions_{static_cast<unsigned int>(output.when().size())},
-    data_{data_map::for_output},
+    records_{output.when().size(),
+             filter_records::for_output,
+             [&output](std::size_t, product_store_const_ptr const& store) {
+               output.release_products(*store);
+             }},
     indexer_{g},
     filter_{g, flow::unlimited, [this](tag_t const& t) { return execute(t); }},
     downstream_ports_{&output.port()},
@@ -38,50 +47,45 @@ namespace meld {
 
   flow::continue_msg filter::execute(tag_t const& t)
   {
-    // FIXME: This implementation is horrible!  Because there are two data structures that
-    //        have to work together.
-    end_of_message_ptr eom{};
-    unsigned int msg_id{};
+    std::optional<filter_decision> decision;
+    std::size_t msg_id{};
     if (t.is_a<message>()) {
       auto const& msg = t.cast_to<message>();
-      data_.update(msg.id, msg.store);
-      msg_id = msg.id;
-      if (msg.store->is_flush()) {
+      if (msg.store and msg.store->is_flush()) {
         // All flush messages are automatically forwarded to downstream ports.
         for (std::size_t i = 0ull; i != nargs_; ++i) {
           downstream_ports_[i]->try_put(msg);
         }
         return {};
       }
+      decision = records_.add_data(msg);
+      msg_id = msg.id;
     }
     else {
       auto const& result = t.cast_to<predicate_result>();
-      decisions_.update(result);
-      eom = result.eom;
+      if (not result.eom) {
+        // Predicates produce an empty result for each flush message.
+        return {};
+      }
+      decision = records_.vote(result);
       msg_id = result.msg_id;
     }
 
-    auto const filter_decision = decisions_.value(msg_id);
-    if (not is_complete(filter_decision)) {
+    // Only the vote or data message that completes the record sees the decision.
+    if (not decision) {
       return {};
     }
 
-    if (not data_.is_complete(msg_id)) {
-      return {};
-    }
-
-    if (to_boolean(filter_decision)) {
-      // FIXME: Can we get rid of this awful accessor?
-      data_map::accessor a;
-      auto const stores = data_.release_data(a, msg_id);
-      if (empty(stores)) {
-        return {};
-      }
+    // The inputs of a rejected message have already been released by the filter records.
+    auto const& [accepted, eom, stores] = *decision;
+    if (accepted) {
       for (std::size_t i = 0ull; i != nargs_; ++i) {
         downstream_ports_[i]->try_put({stores[i], eom, msg_id});
       }
     }
-    decisions_.erase(msg_id);
+    else if (consumer_) {
+      consumer_->reject(msg_id, *decision);
+    }
     return {};
   }
 }
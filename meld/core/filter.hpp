@@ -29,12 +29,12 @@ namespace meld {
   private:
     oneapi::tbb::flow::continue_msg execute(tag_t const& tag);
 
-    decision_map decisions_;
-    data_map data_;
+    filter_records records_;
     indexer_t indexer_;
     oneapi::tbb::flow::function_node<tag_t> filter_;
     std::vector<oneapi::tbb::flow::receiver<message>*> downstream_ports_;
     std::size_t nargs_;
+    products_consumer* consumer_{nullptr};
   };
 }
 
@@ -7,8 +7,15 @@
 
 #include "spdlog/cfg/env.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <ranges>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace meld {
   level_sentry::level_sentry(flush_counters& counters,
@@ -24,7 +31,7 @@ namespace meld {
     auto flush_result = counters_.extract(store_->id());
     auto flush_store = store_->make_flush();
     if (not flush_result.empty()) {
-      flush_store->add_product("[flush]",
+      flush_store->add_product(flush_counts_key(),
                                std::make_shared<flush_counts const>(std::move(flush_result)));
     }
     sender_.send_flush(std::move(flush_store));
@@ -54,13 +61,31 @@ namespace meld {
     parallelism_limit_{static_cast<std::size_t>(max_parallelism)},
     src_{graph_,
          [this, read_next = std::move(next_store)](tbb::flow_control& fc) mutable -> message {
-           auto store = read_next(stores_);
+           auto read = [this, &read_next]() -> product_store_ptr {
+             if (shutdown_) {
+               return nullptr;
+             }
+             auto store = read_next(stores_);
+             shutdown_ = not store;
+             return store;
+           };
+
+           auto store = lookahead_store_ ? std::exchange(lookahead_store_, nullptr) : read();
            if (not store) {
              drain();
              fc.stop();
              return {};
            }
            assert(not store->is_flush());
+
+           // The source reads one store ahead so that it knows whether the current store
+           // will have children.  If it will not, none of its products can be read through
+           // a descendant store, and they may be released once their consumers are done.
+           lookahead_store_ = read();
+           if (not lookahead_store_ or
+               lookahead_store_->id()->depth() <= store->id()->depth()) {
+             store->enable_early_release();
+           }
            return sender_.make_message(accept(std::move(store)));
          }},
     multiplexer_{graph_}
@@ -74,7 +99,32 @@ namespace meld {
     eoms_.push(nullptr);
   }
 
-  framework_graph::~framework_graph() = default;
+  framework_graph::~framework_graph()
+  {
+    // End-of-message objects that are destroyed with the graph's nodes must not return
+    // their tokens to a window whose graph no longer exists.
+    if (event_window_) {
+      event_window_->close();
+    }
+  }
+
+  void framework_graph::evaluate_predicates(predicate_evaluation const mode) noexcept
+  {
+    predicate_evaluation_ = mode;
+  }
+
+  void framework_graph::limit_events_in_flight(std::size_t const max_events)
+  {
+    if (max_events == 0ull) {
+      throw std::runtime_error("The maximum number of events in flight must be positive.");
+    }
+    max_events_in_flight_ = max_events;
+  }
+
+  void framework_graph::limit_memory(std::size_t const budget_bytes, double const high_watermark)
+  {
+    memory_governor_ = std::make_unique<memory_governor>(budget_bytes, high_watermark);
+  }
 
   std::size_t framework_graph::execution_counts(std::string const& node_name) const
   {
@@ -116,6 +166,10 @@ namespace meld {
   {
     finalize(dot_file_prefix);
     run();
+    if (event_window_ and event_window_->governor()) {
+      spdlog::info("Events held to stay within the memory budget: {}",
+                   event_window_->held_events());
+    }
     // post_data_graph(dot_file_prefix);
   }
 
@@ -150,6 +204,183 @@ namespace meld {
       }
       return result;
     }
+
+    // For short-circuit evaluation, the predicates of each when(...) clause are chained in
+    // order of increasing cost: each predicate is guarded by the next-cheaper one, so that
+    // it is evaluated only for messages the cheaper one accepted.  A guarded predicate
+    // votes against every message that its guard rejected, so the vote of a guarded
+    // predicate becomes the conjunction of both.  A predicate is therefore guarded only if
+    // every node that names it in a when(...) clause also names the guard.  The chains are
+    // formed before any predicate runs, so only declared costs are used; predicates
+    // without a declared cost are evaluated as before.
+    void chain_predicates(node_catalog& nodes)
+    {
+      std::vector<consumer*> all_consumers;
+      auto collect = [&all_consumers](auto const& consumers) {
+        for (auto const& consumer : consumers | std::views::values) {
+          all_consumers.push_back(consumer.get());
+        }
+      };
+      collect(nodes.predicates_);
+      collect(nodes.monitors_);
+      collect(nodes.outputs_);
+      collect(nodes.reductions_);
+      collect(nodes.splitters_);
+      collect(nodes.transforms_);
+
+      auto names = [](consumer const* c, std::string const& predicate_name) {
+        return std::ranges::find(c->when(), predicate_name) != c->when().end();
+      };
+      auto can_guard = [&all_consumers, &names](std::string const& guard,
+                                                std::string const& predicate_name) {
+        return std::ranges::all_of(all_consumers, [&](consumer const* c) {
+          return not names(c, predicate_name) or names(c, guard);
+        });
+      };
+
+      for (auto const* c : all_consumers) {
+        std::vector<std::pair<double, std::string>> costs;
+        for (auto const& predicate_name : c->when()) {
+          auto it = nodes.predicates_.find(predicate_name);
+          if (it == nodes.predicates_.end()) {
+            continue; // Reported when the filters are created
+          }
+          if (auto const cost = it->second->cost()) {
+            costs.emplace_back(*cost, predicate_name);
+          }
+        }
+        std::ranges::sort(costs);
+        for (std::size_t i = 1; i < costs.size(); ++i) {
+          auto const& guard = costs[i - 1].second;
+          auto const& predicate_name = costs[i].second;
+          auto& predicate = *nodes.predicates_.at(predicate_name);
+          if (guard == predicate_name or names(&predicate, guard) or
+              not can_guard(guard, predicate_name)) {
+            continue;
+          }
+          spdlog::debug("Predicate {} is evaluated only for messages accepted by {}",
+                        predicate_name,
+                        guard);
+          predicate.add_predicate(guard, "short-circuit");
+        }
+      }
+    }
+
+    // A transform whose products are consumed only by nodes guarded by a predicate need
+    // not run for messages that the predicate rejects.  Each such transform is guarded by
+    // the predicates named by all of its consumers--and by all output nodes, which receive
+    // every product--unless the predicate itself depends on the transform's products.
+    // This is done only if the transform's own predicates are also named by all of its
+    // consumers, so that every message the transform rejects is also rejected downstream.
+    // The process is repeated so that chains of transforms are guarded as well.
+    void push_down_predicates(node_catalog& nodes)
+    {
+      std::vector<products_consumer const*> all_consumers;
+      auto collect = [&all_consumers](auto const& consumers) {
+        for (auto const& consumer : consumers | std::views::values) {
+          all_consumers.push_back(consumer.get());
+        }
+      };
+      collect(nodes.predicates_);
+      collect(nodes.monitors_);
+      collect(nodes.reductions_);
+      collect(nodes.splitters_);
+      collect(nodes.transforms_);
+
+      std::vector<std::pair<products_consumer const*, qualified_names>> producers;
+      auto collect_producers = [&producers](auto const& nodes) {
+        for (auto const& node : nodes | std::views::values) {
+          producers.emplace_back(node.get(), node->output());
+        }
+      };
+      collect_producers(nodes.reductions_);
+      collect_producers(nodes.splitters_);
+      collect_producers(nodes.transforms_);
+
+      auto produces = [](qualified_names const outputs, specified_label const& label) {
+        return std::ranges::any_of(outputs, [&label](qualified_name const& output) {
+          return output.name() == label.name.name() and
+                 output.qualifier().match(label.name.qualifier());
+        });
+      };
+
+      // Whether the node, or any node it depends on, consumes products of the transform
+      std::set<products_consumer const*> visited;
+      auto depends_on = [&](auto const& self,
+                            products_consumer const* node,
+                            products_consumer const* transform) -> bool {
+        if (node == transform) {
+          return true;
+        }
+        if (not visited.insert(node).second) {
+          return false;
+        }
+        for (auto const& label : node->input()) {
+          for (auto const& [producer, outputs] : producers) {
+            if (produces(outputs, label) and self(self, producer, transform)) {
+              return true;
+            }
+          }
+        }
+        for (auto const& predicate_name : node->when()) {
+          auto it = nodes.predicates_.find(predicate_name);
+          if (it != nodes.predicates_.end() and self(self, it->second.get(), transform)) {
+            return true;
+          }
+        }
+        return false;
+      };
+
+      for (bool changed = true; changed;) {
+        changed = false;
+        for (auto const& [name, transform] : nodes.transforms_) {
+          std::vector<std::set<std::string>> guards;
+          for (auto const* c : all_consumers) {
+            if (std::ranges::any_of(c->input(), [&](specified_label const& label) {
+                  return produces(transform->output(), label);
+                })) {
+              guards.emplace_back(c->when().begin(), c->when().end());
+            }
+          }
+          if (empty(guards)) {
+            continue;
+          }
+          for (auto const& output : nodes.outputs_ | std::views::values) {
+            guards.emplace_back(output->when().begin(), output->when().end());
+          }
+
+          auto common = guards.front();
+          for (auto const& g : guards) {
+            std::erase_if(common, [&g](std::string const& p) { return not g.contains(p); });
+          }
+          auto const& own = transform->when();
+          auto is_common = [&common](std::string const& p) { return common.contains(p); };
+          if (not std::ranges::all_of(own, is_common)) {
+            continue;
+          }
+
+          for (auto const& predicate_name : common) {
+            if (std::ranges::find(own, predicate_name) != own.end()) {
+              continue;
+            }
+            auto it = nodes.predicates_.find(predicate_name);
+            visited.clear();
+            if (it == nodes.predicates_.end() or
+                depends_on(depends_on, it->second.get(), transform.get())) {
+              continue;
+            }
+            spdlog::debug("Transform {} is evaluated only for messages accepted by {}",
+                          name,
+                          predicate_name);
+            transform->add_predicate(predicate_name, "pushdown");
+            changed = true;
+          }
+          if (not empty(own)) {
+            transform->send_placeholders_on_rejection();
+          }
+        }
+      }
+    }
   }
 
   void framework_graph::finalize(std::string const& dot_file_prefix)
@@ -162,6 +393,11 @@ namespace meld {
       throw std::runtime_error(error_msg);
     }
 
+    if (predicate_evaluation_ == predicate_evaluation::short_circuit) {
+      chain_predicates(nodes_);
+    }
+    push_down_predicates(nodes_);
+
     filters_.merge(internal_edges_for_predicates(graph_, nodes_.predicates_, nodes_.predicates_));
     filters_.merge(internal_edges_for_predicates(graph_, nodes_.predicates_, nodes_.monitors_));
     filters_.merge(internal_edges_for_predicates(graph_, nodes_.predicates_, nodes_.outputs_));
@@ -169,8 +405,25 @@ namespace meld {
     filters_.merge(internal_edges_for_predicates(graph_, nodes_.predicates_, nodes_.splitters_));
     filters_.merge(internal_edges_for_predicates(graph_, nodes_.predicates_, nodes_.transforms_));
 
+    tbb::flow::sender<message>* source = &src_;
+    if (memory_governor_ and max_events_in_flight_ == 0ull) {
+      max_events_in_flight_ = 2ull * concurrency::max_allowed_parallelism::active_value();
+    }
+    if (max_events_in_flight_ > 0ull) {
+      if (memory_governor_) {
+        spdlog::info("Memory budget: {:.3f} MB (high watermark: {:.3f} MB)",
+                     memory_governor_->budget() / 1e6,
+                     memory_governor_->high_watermark() / 1e6);
+      }
+      event_window_ =
+        std::make_unique<event_window>(graph_, max_events_in_flight_, std::move(memory_governor_));
+      spdlog::info("Maximum number of events in flight: {}", event_window_->max_events());
+      make_edge(src_, event_window_->input());
+      source = &event_window_->output();
+    }
+
     edge_maker make_edges{dot_file_prefix, nodes_.transforms_, nodes_.reductions_};
-    make_edges(src_,
+    make_edges(*source,
                multiplexer_,
                filters_,
                nodes_.outputs_,
@@ -180,6 +433,8 @@ namespace meld {
                consumers{nodes_.splitters_, {.shape = "trapezium"}},
                consumers{nodes_.transforms_, {.shape = "box"}});
 
+    spdlog::debug("Number of registered product keys: {}", product_key::registered_keys());
+
     if (auto data_graph = make_edges.release_data_graph()) {
       data_graph->to_file(dot_file_prefix);
     }
@@ -193,6 +448,8 @@ namespace meld {
     assert(store);
     auto const new_depth = store->id()->depth();
     while (not empty(levels_) and new_depth <= levels_.top().depth()) {
+      // The flush sent by the level sentry carries the level's end-of-message object, so
+      // the sentry must be removed first.
       levels_.pop();
       eoms_.pop();
     }
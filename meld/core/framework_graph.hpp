@@ -6,6 +6,7 @@
 #include "meld/core/declared_reduction.hpp"
 #include "meld/core/declared_splitter.hpp"
 #include "meld/core/end_of_message.hpp"
+#include "meld/core/event_window.hpp"
 #include "meld/core/filter.hpp"
 #include "meld/core/glue.hpp"
 #include "meld/core/graph_proxy.hpp"
@@ -23,6 +24,7 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <queue>
 #include <stack>
 #include <string>
@@ -47,6 +49,11 @@ namespace meld {
 
   class framework_graph {
   public:
+    // The source function is called one store ahead of the store being processed: a
+    // store is only sent once the next store has been read, so that the products of a
+    // store without children can be released as soon as their consumers are done.  A
+    // source must therefore not rely on its stores having been processed when it is
+    // called again.
     explicit framework_graph(product_store_ptr store,
                              int max_parallelism = oneapi::tbb::info::default_concurrency());
     explicit framework_graph(std::function<product_store_ptr()> f,
@@ -57,6 +64,24 @@ namespace meld {
 
     void execute(std::string const& dot_prefix = {});
 
+    // Must be called before execute()
+    void evaluate_predicates(predicate_evaluation mode) noexcept;
+
+    // Must be called before execute(); limits the number of events (stores without child
+    // stores) that are processed concurrently.  The source stops reading stores while the
+    // limit is reached.
+    void limit_events_in_flight(std::size_t max_events);
+
+    // Must be called before execute(); the source pauses while the memory usage is above
+    // the high watermark, specified as a fraction of the budget (see memory_governor).
+    // Unless limit_events_in_flight() is called, at most two events per thread are in
+    // flight.
+    void limit_memory(std::size_t budget_bytes, double high_watermark = 0.9);
+
+    // A transform whose products are consumed only by nodes guarded by a predicate is
+    // itself guarded by that predicate when the graph is finalized, so it is not called
+    // for messages the predicate rejects.  Its execution count is then the number of
+    // accepted messages rather than the number of messages it would otherwise receive.
     std::size_t execution_counts(std::string const& node_name) const;
     std::size_t product_counts(std::string const& node_name) const;
 
@@ -108,16 +133,21 @@ namespace meld {
     resource_usage graph_resource_usage_{};
     concurrency::max_allowed_parallelism parallelism_limit_;
     level_hierarchy hierarchy_{};
+    std::unique_ptr<event_window> event_window_{}; // Outlives all end_of_message objects
     cached_product_stores stores_{};
     node_catalog nodes_{};
     tbb::flow::graph graph_{};
     std::vector<std::string> registration_errors_{};
     std::map<std::string, filter> filters_{};
+    predicate_evaluation predicate_evaluation_{predicate_evaluation::all};
+    std::size_t max_events_in_flight_{};
+    std::unique_ptr<memory_governor> memory_governor_{};
     tbb::flow::input_node<message> src_;
     multiplexer multiplexer_;
     std::stack<end_of_message_ptr> eoms_;
     message_sender sender_{hierarchy_, multiplexer_, eoms_};
     std::queue<product_store_ptr> pending_stores_;
+    product_store_ptr lookahead_store_{}; // Read, but not yet sent, by the source
     flush_counters counters_;
     std::stack<level_sentry> levels_;
     bool shutdown_{false};
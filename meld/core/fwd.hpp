@@ -1,20 +1,29 @@
 #ifndef meld_core_fwd_hpp
 #define meld_core_fwd_hpp
 
+#include "boost/smart_ptr/intrusive_ptr.hpp"
+
 #include <memory>
 
 namespace meld {
   class cached_product_stores;
   class component;
+  class consumer_counts;
   class declared_output;
   class end_of_message;
+  class event_window;
   class generator;
   class framework_graph;
   class message_sender;
   class multiplexer;
   class products_consumer;
 
-  using end_of_message_ptr = std::shared_ptr<end_of_message>;
+  // End-of-message objects are reference-counted intrusively: copying an end_of_message_ptr
+  // (as is done for every message) increments a counter within the object itself, without
+  // the separate control block of a std::shared_ptr.
+  void intrusive_ptr_add_ref(end_of_message const* eom) noexcept;
+  void intrusive_ptr_release(end_of_message const* eom) noexcept;
+  using end_of_message_ptr = boost::intrusive_ptr<end_of_message>;
 }
 
 #endif // meld_core_fwd_hpp
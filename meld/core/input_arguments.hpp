@@ -3,6 +3,8 @@
 
 #include "meld/core/message.hpp"
 #include "meld/core/specified_label.hpp"
+#include "meld/model/product_key.hpp"
+#include "meld/model/type_id.hpp"
 
 #include "fmt/format.h"
 
@@ -19,10 +21,11 @@ namespace meld {
   struct retriever {
     using handle_arg_t = typename handle_for<T>::value_type;
     specified_label label;
+    product_key key{label.name.name()};
+    static type_id type() { return type_id_for<handle_arg_t>(); }
     auto retrieve(auto const& messages) const
     {
-      return std::get<JoinNodePort>(messages).store->template get_handle<handle_arg_t>(
-        label.name.name());
+      return std::get<JoinNodePort>(messages).store->template get_handle<handle_arg_t>(key);
     }
   };
 
@@ -0,0 +1,51 @@
+#include "meld/core/memory_governor.hpp"
+#include "meld/model/products.hpp"
+#include "meld/utilities/resource_usage.hpp"
+
+#include <stdexcept>
+
+using namespace std::chrono;
+
+namespace {
+  // Reading the RSS requires a system call; it is therefore sampled at most this often.
+  constexpr auto rss_sampling_interval = milliseconds{10};
+}
+
+namespace meld {
+  memory_governor::memory_governor(std::size_t const budget_bytes, double const high_watermark) :
+    budget_{budget_bytes}, high_watermark_{static_cast<std::size_t>(budget_ * high_watermark)}
+  {
+    if (budget_ == 0ull) {
+      throw std::runtime_error("The memory budget must be positive.");
+    }
+    if (high_watermark <= 0. or high_watermark > 1.) {
+      throw std::runtime_error("The high watermark must be a fraction of the memory budget.");
+    }
+  }
+
+  std::size_t memory_governor::budget() const noexcept { return budget_; }
+  std::size_t memory_governor::high_watermark() const noexcept { return high_watermark_; }
+
+  std::size_t memory_governor::usage()
+  {
+    if (product_sizes_reported()) {
+      return live_product_bytes();
+    }
+    return sampled_rss();
+  }
+
+  bool memory_governor::above_high_watermark() { return usage() > high_watermark_; }
+
+  std::size_t memory_governor::sampled_rss()
+  {
+    auto const now = steady_clock::now();
+    auto next = next_sample_.load(std::memory_order_relaxed);
+    if (now.time_since_epoch().count() >= next) {
+      auto const following = (now + rss_sampling_interval).time_since_epoch().count();
+      if (next_sample_.compare_exchange_strong(next, following)) {
+        rss_.store(resource_usage::current_rss(), std::memory_order_relaxed);
+      }
+    }
+    return rss_.load(std::memory_order_relaxed);
+  }
+}
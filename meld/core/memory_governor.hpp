@@ -0,0 +1,38 @@
+#ifndef meld_core_memory_governor_hpp
+#define meld_core_memory_governor_hpp
+
+// =======================================================================================
+// A memory_governor compares the memory usage of the job against a budget.  The usage is
+// the number of bytes held by live products whose types have size hooks (see
+// product_size in meld/model/products.hpp).  If no such product has been created, the
+// resident set size of the process is sampled instead.  While the usage is above the
+// high watermark (a fraction of the budget), the event window does not start processing
+// new events, and the source therefore pauses once the window is full.
+// =======================================================================================
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace meld {
+  class memory_governor {
+  public:
+    memory_governor(std::size_t budget_bytes, double high_watermark);
+
+    std::size_t budget() const noexcept;
+    std::size_t high_watermark() const noexcept;
+
+    std::size_t usage();
+    bool above_high_watermark();
+
+  private:
+    std::size_t sampled_rss();
+
+    std::size_t budget_;
+    std::size_t high_watermark_;
+    std::atomic<std::size_t> rss_{};
+    std::atomic<std::chrono::steady_clock::rep> next_sample_{};
+  };
+}
+
+#endif // meld_core_memory_governor_hpp
@@ -2,12 +2,35 @@
 #include "meld/model/level_id.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <iterator>
 #include <stdexcept>
 #include <tuple>
 
+namespace {
+  constexpr std::size_t id_block_size{1024};
+
+  // ID 0 is never allocated.
+  std::atomic<std::size_t> next_id_block{1};
+
+  struct id_block {
+    std::size_t next{};
+    std::size_t end{};
+  };
+  thread_local id_block ids{};
+}
+
 namespace meld {
 
+  std::size_t next_message_id() noexcept
+  {
+    if (ids.next == ids.end) {
+      ids.next = next_id_block.fetch_add(id_block_size, std::memory_order_relaxed);
+      ids.end = ids.next + id_block_size;
+    }
+    return ids.next++;
+  }
+
   std::size_t MessageHasher::operator()(message const& msg) const noexcept { return msg.id; }
 
   message const& more_derived(message const& a, message const& b)
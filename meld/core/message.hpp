@@ -1,6 +1,7 @@
 #ifndef meld_core_message_hpp
 #define meld_core_message_hpp
 
+#include "meld/core/detail/message_join.hpp"
 #include "meld/core/fwd.hpp"
 #include "meld/core/specified_label.hpp"
 #include "meld/model/handle.hpp"
@@ -28,6 +29,11 @@ namespace meld {
   template <std::size_t N>
   using messages_t = sized_tuple<message, N>;
 
+  // Returns a framework-wide unique message ID.  Each thread draws IDs from its own block
+  // of consecutive IDs, so that IDs can be allocated without contention; IDs are therefore
+  // unique but not ordered across threads.
+  std::size_t next_message_id() noexcept;
+
   struct MessageHasher {
     std::size_t operator()(message const& msg) const noexcept;
   };
@@ -37,7 +43,11 @@ namespace meld {
 
   namespace detail {
     template <std::size_t N>
-    using join_messages_t = tbb::flow::join_node<messages_t<N>, tbb::flow::tag_matching>;
+    using join_messages_t = message_join<N, message>;
+
+    // The TBB join previously used by multi-input nodes (kept for comparisons)
+    template <std::size_t N>
+    using tag_matching_join_t = tbb::flow::join_node<messages_t<N>, tbb::flow::tag_matching>;
     using no_join_base_t =
       tbb::flow::function_node<message, messages_t<1ull>, tbb::flow::lightweight>;
 
@@ -55,7 +65,12 @@ namespace meld {
   template <std::size_t... Is>
   auto make_join_or_none(tbb::flow::graph& g, std::index_sequence<Is...>)
   {
-    return join_or_none_t<sizeof...(Is)>{g, type_t<MessageHasher, Is>{}...};
+    if constexpr (sizeof...(Is) == 1ull) {
+      return detail::no_join{g, MessageHasher{}};
+    }
+    else {
+      return detail::join_messages_t<sizeof...(Is)>{g};
+    }
   }
 
   template <std::size_t N>
@@ -4,6 +4,7 @@
 #include "meld/model/product_store.hpp"
 
 #include <cassert>
+#include <utility>
 
 namespace meld {
   message_sender::message_sender(level_hierarchy& hierarchy,
@@ -17,9 +18,9 @@ namespace meld {
   {
     assert(store);
     assert(not store->is_flush());
-    auto const message_id = ++calls_;
+    auto const message_id = next_message_id();
     original_message_ids_.try_emplace(store->id(), message_id);
-    auto parent_eom = eoms_.top();
+    auto const& parent_eom = eoms_.top();
     end_of_message_ptr current_eom{};
     if (parent_eom == nullptr) {
       current_eom = eoms_.emplace(end_of_message::make_base(&hierarchy_, store->id()));
@@ -27,15 +28,19 @@ namespace meld {
     else {
       current_eom = eoms_.emplace(parent_eom->make_child(store->id()));
     }
-    return {store, current_eom, message_id, -1ull};
+    return {std::move(store), std::move(current_eom), message_id, -1ull};
   }
 
   void message_sender::send_flush(product_store_ptr store)
   {
     assert(store);
     assert(store->is_flush());
-    auto const message_id = ++calls_;
-    message const msg{store, nullptr, message_id, original_message_id(store)};
+    auto const message_id = next_message_id();
+    // The flush message carries the end-of-message object of its level instance, which is
+    // therefore not destroyed until the flush has been processed by all nodes.
+    auto const& eom = eoms_.top();
+    assert(eom and eom->id() == store->id());
+    message const msg{store, eom, message_id, original_message_id(store)};
     multiplexer_.try_put(std::move(msg));
   }
 
@@ -27,7 +27,6 @@ namespace meld {
     multiplexer& multiplexer_;
     std::stack<end_of_message_ptr>& eoms_;
     std::map<level_id_ptr, std::size_t> original_message_ids_;
-    std::size_t calls_{};
   };
 
 }
@@ -5,61 +5,48 @@
 #include "spdlog/spdlog.h"
 
 #include <algorithm>
+#include <optional>
 #include <ranges>
 #include <stdexcept>
 
 using namespace std::chrono;
 
 namespace {
-  meld::product_store_const_ptr store_for(meld::product_store_const_ptr store,
-                                          meld::specified_label const& label)
+  // Number of steps from the received store (the first store of the chain) to the store
+  // that provides the port's product, if any
+  std::optional<std::size_t> steps_to(meld::multiplexer::store_chain_t const& chain,
+                                      meld::multiplexer::named_input_port const& port)
   {
-    auto const& [product_name, family, relation] = label;
-    if (family.empty()) {
-      return store->store_for_product(product_name.full());
-    }
-    if (store->level_name() == family and store->contains_product(product_name.full())) {
-      return store;
-    }
-    auto parent = store->parent(family);
-    if (not parent) {
-      return nullptr;
-    }
-    if (parent->contains_product(product_name.full())) {
-      return parent;
+    auto const& [label, _, key, family] = port;
+    if (not family.valid()) {
+      for (std::size_t i = 0; i != chain.size(); ++i) {
+        if (chain[i]->contains_product(key)) {
+          return i;
+        }
+      }
+      return std::nullopt;
     }
-    throw std::runtime_error(
-      fmt::format("Store not available that provides product {}", label.to_string()));
-  }
-
-  struct sender_slot {
-    tbb::flow::receiver<meld::message>* port;
-    meld::product_store_const_ptr store;
-    void operator()(meld::end_of_message_ptr eom, std::size_t message_id) const
-    {
-      port->try_put({store, eom, message_id});
+    if (chain[0]->id()->level_name_key() == family and chain[0]->contains_product(key)) {
+      return 0ull;
     }
-  };
-
-  std::vector<sender_slot> senders_for(meld::product_store_const_ptr store,
-                                       meld::multiplexer::named_input_ports_t const& ports)
-  {
-    std::vector<sender_slot> result;
-    result.reserve(ports.size());
-    for (auto const& [product_label, port] : ports) {
-      auto store_to_send = store_for(store, product_label);
-      if (not store_to_send) {
-        // This is fine if the store is not expected to contain the product.
+    for (std::size_t i = 1; i != chain.size(); ++i) {
+      if (chain[i]->id()->level_name_key() != family) {
         continue;
       }
-
-      if (auto const& allowed_family = product_label.family; not allowed_family.empty()) {
-        if (store_to_send->level_name() != allowed_family) {
-          continue;
-        }
+      if (chain[i]->contains_product(key)) {
+        return i;
       }
+      throw std::runtime_error(
+        fmt::format("Store not available that provides product {}", label.to_string()));
+    }
+    return std::nullopt;
+  }
 
-      result.push_back({port, store_to_send});
+  meld::multiplexer::store_chain_t chain_of(meld::product_store const& store)
+  {
+    meld::multiplexer::store_chain_t result;
+    for (auto const* s = &store; s != nullptr; s = s->parent().get()) {
+      result.push_back(s);
     }
     return result;
   }
@@ -72,7 +59,18 @@ namespace meld {
   {
   }
 
-  void multiplexer::finalize(head_ports_t head_ports) { head_ports_ = std::move(head_ports); }
+  void multiplexer::finalize(head_ports_t head_ports)
+  {
+    // Resolve the product keys and level names once so that routing each message does not
+    // require hashing or comparing any strings.
+    for (auto& port : head_ports | std::views::values | std::views::join) {
+      port.key = product_key{port.product_label.name.full()};
+      if (not port.product_label.family.empty()) {
+        port.family_key = level_key{port.product_label.family};
+      }
+    }
+    head_ports_ = std::move(head_ports);
+  }
 
   tbb::flow::continue_msg multiplexer::multiplex(message const& msg)
   {
@@ -93,24 +91,45 @@ namespace meld {
       return {};
     }
 
-    for (auto const& ports : head_ports_ | std::views::values) {
-      // FIXME: Should make sure that the received store has a level equal to the most
-      //        derived store required by the algorithm.
-      auto const senders = senders_for(store, ports);
-      if (size(senders) != size(ports)) {
-        // Not enough stores to ports of the node
-        continue;
-      }
+    shape_key const shape{store->shape_hash(), store->id()->level_name_key()};
+    auto it = routing_tables_.find(shape);
+    if (it == routing_tables_.end()) {
+      // Two threads may compute the table for the same shape; only one is kept.
+      it = routing_tables_.emplace(shape, make_routing_table(chain_of(*store))).first;
+    }
 
-      for (auto const& sender : senders) {
-        sender(eom, message_id);
+    product_store_const_ptr const* store_to_send = &store;
+    std::size_t depth{};
+    for (auto const& [port, steps] : it->second) {
+      for (; depth != steps; ++depth) {
+        store_to_send = &(*store_to_send)->parent();
       }
+      port->try_put({*store_to_send, eom, message_id});
     }
 
     execution_time_ += duration_cast<microseconds>(steady_clock::now() - start_time);
     return {};
   }
 
+  auto multiplexer::make_routing_table(store_chain_t const& chain) const -> routing_table
+  {
+    routing_table result;
+    for (auto const& ports : head_ports_ | std::views::values) {
+      auto const node_begin = size(result);
+      for (auto const& port : ports) {
+        auto const steps = steps_to(chain, port);
+        if (not steps) {
+          // Not enough stores to ports of the node
+          result.resize(node_begin);
+          break;
+        }
+        result.push_back({port.port, *steps});
+      }
+    }
+    std::ranges::stable_sort(result, {}, &route::steps);
+    return result;
+  }
+
   multiplexer::~multiplexer()
   {
     spdlog::debug("Routed {} messages in {} microseconds ({:.3f} microseconds per message)",
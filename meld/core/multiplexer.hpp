@@ -3,16 +3,21 @@
 
 #include "meld/core/message.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/model/product_key.hpp"
 
+#include "boost/container/small_vector.hpp"
 #include "oneapi/tbb/concurrent_hash_map.h"
+#include "oneapi/tbb/concurrent_unordered_map.h"
 #include "oneapi/tbb/flow_graph.h"
 
 #include <chrono>
+#include <cstddef>
 #include <functional>
 #include <map>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace meld {
 
@@ -25,6 +30,8 @@ namespace meld {
     struct named_input_port {
       specified_label product_label;
       tbb::flow::receiver<message>* port;
+      product_key key{};      // Assigned by multiplexer::finalize
+      level_key family_key{}; // Assigned by multiplexer::finalize
     };
     using named_input_ports_t = std::vector<named_input_port>;
     using head_ports_t = std::map<std::string, named_input_ports_t>;
@@ -36,8 +43,40 @@ namespace meld {
 
     head_ports_t const& downstream_ports() const noexcept { return head_ports_; }
 
+    // Chain of stores from the received store (index 0) up to the job-level store
+    using store_chain_t = boost::container::small_vector<product_store const*, 6>;
+
   private:
+    // A route sends the store that is 'steps' levels above the received store to a port.
+    struct route {
+      tbb::flow::receiver<message>* port;
+      std::size_t steps;
+    };
+
+    // All stores with the same shape--i.e. the same level types and the same product keys
+    // for each store in the chain--are routed identically.  A node's input products are
+    // looked up only in the stores of the chain (continuations of those stores never
+    // provide the products of head ports), so the routes follow from the shape alone.
+    // The routing table for a shape is computed the first time a store of that shape is
+    // received.  Each store caches the hash of its shape (see product_store::shape_hash),
+    // so finding the table for a store requires neither allocations nor a walk of the
+    // chain.
+    struct shape_key {
+      std::size_t hash;
+      level_key level;
+      bool operator==(shape_key const&) const = default;
+    };
+    struct shape_key_hash {
+      std::size_t operator()(shape_key const& key) const noexcept { return key.hash; }
+    };
+    // Routes are ordered by increasing number of steps, so that the stores to send are
+    // found in one walk up the chain.
+    using routing_table = std::vector<route>;
+
+    routing_table make_routing_table(store_chain_t const& chain) const;
+
     head_ports_t head_ports_;
+    tbb::concurrent_unordered_map<shape_key, routing_table, shape_key_hash> routing_tables_;
     bool debug_;
     std::atomic<std::size_t> received_messages_{};
     std::chrono::duration<float, std::chrono::microseconds::period> execution_time_{};
@@ -1,4 +1,6 @@
 #include "meld/core/products_consumer.hpp"
+#include "meld/core/consumer_counts.hpp"
+#include "meld/model/product_store.hpp"
 
 namespace meld {
 
@@ -16,4 +18,32 @@ namespace meld {
     return port_for(product_label);
   }
 
+  void products_consumer::set_consumer_counts(consumer_counts const& counts)
+  {
+    input_consumers_.clear();
+    for (auto const& label : input()) {
+      product_key const key{label.name.name()};
+      input_consumers_.emplace_back(key, counts.for_product(key));
+    }
+  }
+
+  void products_consumer::reject(std::size_t, filter_decision const&) {}
+
+  void products_consumer::release_inputs(std::span<product_store_const_ptr const> stores) const
+  {
+    for (std::size_t i = 0ull, n = stores.size(); i != n; ++i) {
+      release_input(i, stores[i]);
+    }
+  }
+
+  void products_consumer::release_input(std::size_t const index,
+                                        product_store_const_ptr const& store) const
+  {
+    if (not store or index >= input_consumers_.size()) {
+      return;
+    }
+    auto const& [key, consumers] = input_consumers_[index];
+    store->release_after_use(key, consumers);
+  }
+
 }
@@ -2,16 +2,21 @@
 #define meld_core_products_consumer_hpp
 
 #include "meld/core/consumer.hpp"
+#include "meld/core/detail/filter_impl.hpp"
 #include "meld/core/fwd.hpp"
 #include "meld/core/message.hpp"
 #include "meld/core/specified_label.hpp"
 #include "meld/model/algorithm_name.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/model/product_key.hpp"
+#include "meld/model/type_id.hpp"
 
 #include "oneapi/tbb/flow_graph.h"
 
+#include <cstddef>
 #include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace meld {
@@ -26,10 +31,37 @@ namespace meld {
     tbb::flow::receiver<message>& port(specified_label const& product_label);
     virtual std::vector<tbb::flow::receiver<message>*> ports() = 0;
     virtual specified_labels input() const = 0;
+    virtual type_ids input_types() const = 0; // Ordered as the input labels
     virtual std::size_t num_calls() const = 0;
 
+    // Called once the graph has been finalized; afterwards, each input product is
+    // released as soon as all of its consumers have used it.
+    void set_consumer_counts(consumer_counts const& counts);
+
+    // Records that the node has finished using (or will never use) the input products
+    // held by the specified stores, which are ordered as the node's input ports.
+    void release_inputs(std::span<product_store_const_ptr const> stores) const;
+    void release_input(std::size_t index, product_store_const_ptr const& store) const;
+
+    // Called when the node's filter has rejected a message.  Nodes whose results are
+    // awaited by other filters notify them here that no result will be produced.
+    virtual void reject(std::size_t msg_id, filter_decision const& decision);
+
+  protected:
+    template <typename Messages>
+      requires requires { std::tuple_size<Messages>::value; }
+    void release_inputs(Messages const& messages) const
+    {
+      [this]<std::size_t... Is>(Messages const& messages, std::index_sequence<Is...>) {
+        (release_input(Is, std::get<Is>(messages).store), ...);
+      }(messages, std::make_index_sequence<std::tuple_size_v<Messages>>{});
+    }
+
   private:
     virtual tbb::flow::receiver<message>& port_for(specified_label const& product_label) = 0;
+
+    // Each input product, along with its total number of consumers
+    std::vector<std::pair<product_key, std::size_t>> input_consumers_;
   };
 }
 
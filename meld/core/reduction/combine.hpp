@@ -0,0 +1,51 @@
+#ifndef meld_core_reduction_combine_hpp
+#define meld_core_reduction_combine_hpp
+
+// =======================================================================================
+// A reduction that is declared with a combine function accumulates its contributions in
+// one partial result per thread.  Once all contributions for a reduction interval have
+// been made, the partial results are merged pairwise in a tree, where the merges at each
+// level of the tree are executed in parallel.  For a combine function 'void(R& a, R
+// const& b)', the contents of 'b' must be merged into 'a'.
+//
+// Result types that provide a 'void merge(R const&)' member function are combinable; such
+// a reduction is declared with 'combined()' to be combined using that function.
+// =======================================================================================
+
+#include "oneapi/tbb/parallel_for.h"
+
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace meld {
+  template <typename R>
+  concept combinable = requires(R& a, R const& b) {
+    { a.merge(b) } -> std::same_as<void>;
+  };
+
+  template <typename R, typename F>
+  std::unique_ptr<R> combine_in_tree(std::vector<std::unique_ptr<R>> partials, F const& combine)
+  {
+    std::erase(partials, nullptr);
+    if (empty(partials)) {
+      return nullptr;
+    }
+
+    auto const n = partials.size();
+    for (std::size_t stride = 1; stride < n; stride *= 2) {
+      auto const n_merges = (n - stride + 2 * stride - 1) / (2 * stride);
+      tbb::parallel_for(std::size_t{}, n_merges, [&partials, stride, &combine](std::size_t i) {
+        auto const left = 2 * stride * i;
+        auto& right = partials[left + stride];
+        combine(*partials[left], std::as_const(*right));
+        right.reset();
+      });
+    }
+    return std::move(partials.front());
+  }
+}
+
+#endif // meld_core_reduction_combine_hpp
@@ -0,0 +1,170 @@
+#ifndef meld_core_reduction_statistics_hpp
+#define meld_core_reduction_statistics_hpp
+
+// =======================================================================================
+// Ready-made reduction types for monitoring quantities over a reduction interval:
+//
+//   - histogram: fixed-width bins over [low, high), plus underflow and overflow bins
+//   - running_stats: count, mean, and variance
+//   - extrema<T>: minimum and maximum values
+//
+// Each type provides a 'merge' member function and is therefore combinable (see
+// reduction/combine.hpp): when declared with 'combined()', the framework fills one partial
+// object per thread and merges the partial objects once the interval has been processed.
+// A reduction is registered with the corresponding fill function:
+//
+//   g.with("fill_energy", fill_histogram, concurrency::unlimited)
+//     .reduce("energy")
+//     .for_each("run")
+//     .to("energy_histogram")
+//     .initialized_with(100, 0., 50.) // Number of bins, low edge, high edge
+//     .combined();
+// =======================================================================================
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace meld {
+
+  class histogram {
+  public:
+    histogram(std::integral auto n_bins, double low, double high) :
+      low_{low},
+      high_{high},
+      scale_{static_cast<double>(n_bins) / (high - low)},
+      counts_(static_cast<std::size_t>(n_bins) + 2)
+    {
+      assert(n_bins > 0 and low < high);
+    }
+
+    void fill(double x)
+    {
+      ++counts_[bin_for(x)];
+      ++entries_;
+    }
+
+    void merge(histogram const& other)
+    {
+      assert(counts_.size() == other.counts_.size());
+      auto* counts = counts_.data();
+      auto const* other_counts = other.counts_.data();
+      for (std::size_t i = 0, n = counts_.size(); i != n; ++i) {
+        counts[i] += other_counts[i];
+      }
+      entries_ += other.entries_;
+    }
+
+    std::size_t n_bins() const noexcept { return counts_.size() - 2; }
+    double low() const noexcept { return low_; }
+    double high() const noexcept { return high_; }
+    std::size_t entries() const noexcept { return entries_; }
+
+    // Bin i covers [low + i*width, low + (i+1)*width)
+    std::size_t count(std::size_t i) const { return counts_.at(i + 1); }
+    std::size_t underflow() const noexcept { return counts_.front(); }
+    std::size_t overflow() const noexcept { return counts_.back(); }
+
+  private:
+    std::size_t bin_for(double x) const noexcept
+    {
+      if (not(x >= low_)) { // NaN values are counted as underflow
+        return 0;
+      }
+      if (x >= high_) {
+        return counts_.size() - 1;
+      }
+      return std::min(static_cast<std::size_t>((x - low_) * scale_) + 1, counts_.size() - 2);
+    }
+
+    double low_;
+    double high_;
+    double scale_;
+    std::vector<std::size_t> counts_; // Underflow, regular bins, overflow
+    std::size_t entries_{};
+  };
+
+  class running_stats {
+  public:
+    void add(double x) noexcept
+    {
+      // Welford's algorithm
+      ++n_;
+      auto const delta = x - mean_;
+      mean_ += delta / static_cast<double>(n_);
+      m2_ += delta * (x - mean_);
+    }
+
+    void merge(running_stats const& other) noexcept
+    {
+      if (other.n_ == 0) {
+        return;
+      }
+      auto const n = n_ + other.n_;
+      auto const delta = other.mean_ - mean_;
+      auto const n_a = static_cast<double>(n_);
+      auto const n_b = static_cast<double>(other.n_);
+      mean_ += delta * n_b / static_cast<double>(n);
+      m2_ += other.m2_ + delta * delta * n_a * n_b / static_cast<double>(n);
+      n_ = n;
+    }
+
+    std::size_t count() const noexcept { return n_; }
+    double mean() const noexcept { return mean_; }
+
+    // Sample variance; zero for fewer than two values
+    double variance() const noexcept
+    {
+      return n_ > 1 ? m2_ / static_cast<double>(n_ - 1) : 0.;
+    }
+    double standard_deviation() const noexcept { return std::sqrt(variance()); }
+
+  private:
+    std::size_t n_{};
+    double mean_{};
+    double m2_{};
+  };
+
+  template <typename T>
+  class extrema {
+  public:
+    void add(T const& x)
+    {
+      min_ = std::min(min_, x);
+      max_ = std::max(max_, x);
+      ++n_;
+    }
+
+    void merge(extrema const& other)
+    {
+      min_ = std::min(min_, other.min_);
+      max_ = std::max(max_, other.max_);
+      n_ += other.n_;
+    }
+
+    bool empty() const noexcept { return n_ == 0; }
+    T const& min() const noexcept { return min_; }
+    T const& max() const noexcept { return max_; }
+
+  private:
+    T min_{std::numeric_limits<T>::max()};
+    T max_{std::numeric_limits<T>::lowest()};
+    std::size_t n_{};
+  };
+
+  // Fill functions for registering reductions
+  inline void fill_histogram(histogram& h, double x) { h.fill(x); }
+  inline void accumulate_stats(running_stats& s, double x) { s.add(x); }
+
+  template <typename T>
+  void find_extrema(extrema<T>& e, T x)
+  {
+    e.add(x);
+  }
+}
+
+#endif // meld_core_reduction_statistics_hpp
@@ -0,0 +1,42 @@
+#ifndef meld_core_reduction_window_hpp
+#define meld_core_reduction_window_hpp
+
+// =======================================================================================
+// A window reduction reduces over windows of consecutive instances of one level (e.g.
+// 100 consecutive events) within each parent level instance, instead of over all children
+// of a parent level instance.  Window k covers the instances numbered
+//
+//   [k * stride, k * stride + size)
+//
+// so that tumbling windows have 'stride == size', and sliding windows have 'stride <
+// size'.  Each window's result is emitted as soon as all of its instances have been
+// processed.  Windows that are incomplete when their parent level instance ends are
+// discarded.
+// =======================================================================================
+
+#include <cstddef>
+#include <string>
+
+namespace meld {
+  struct window_spec {
+    std::string level_name;
+    std::size_t size;
+    std::size_t stride;
+  };
+
+  // The inclusive range of windows that contain a given instance; the range is empty
+  // (first > last) if the instance falls in a gap between windows (stride > size).
+  struct window_range {
+    std::size_t first;
+    std::size_t last;
+  };
+
+  inline window_range windows_containing(std::size_t const instance,
+                                         window_spec const& spec) noexcept
+  {
+    auto const first = instance < spec.size ? 0 : (instance - spec.size) / spec.stride + 1;
+    return {first, instance / spec.stride};
+  }
+}
+
+#endif // meld_core_reduction_window_hpp
@@ -28,7 +28,11 @@ namespace meld {
 
   bool detect_flush_flag::done_with(product_store_const_ptr const& store)
   {
-    auto const h = store->id()->hash();
+    return done_with(store->id()->hash());
+  }
+
+  bool detect_flush_flag::done_with(level_id::hash_type const h)
+  {
     if (const_flag_accessor fa; flags_.find(fa, h) && fa->second->is_complete()) {
       flags_.erase(fa);
       return true;
@@ -41,14 +45,14 @@ namespace meld {
   void store_counter::set_flush_value(product_store_const_ptr const& store,
                                       std::size_t const original_message_id)
   {
-    if (not store->contains_product("[flush]")) {
+    if (not store->contains_product(flush_counts_key())) {
       return;
     }
 
 #ifdef __cpp_lib_atomic_shared_ptr
-    flush_counts_ = store->get_product<flush_counts_ptr>("[flush]");
+    flush_counts_ = store->get_product<flush_counts_ptr>(flush_counts_key());
 #else
-    atomic_store(&flush_counts_, store->get_product<flush_counts_ptr>("[flush]"));
+    atomic_store(&flush_counts_, store->get_product<flush_counts_ptr>(flush_counts_key()));
 #endif
     original_message_id_ = original_message_id;
   }
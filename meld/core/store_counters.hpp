@@ -31,6 +31,7 @@ namespace meld {
   protected:
     store_flag& flag_for(level_id::hash_type hash);
     bool done_with(product_store_const_ptr const& store);
+    bool done_with(level_id::hash_type hash);
 
   private:
     using flags_t = tbb::concurrent_hash_map<level_id::hash_type, std::unique_ptr<store_flag>>;
@@ -1,6 +1,8 @@
 #ifndef meld_model_fwd_hpp
 #define meld_model_fwd_hpp
 
+#include "boost/smart_ptr/intrusive_ptr.hpp"
+
 #include <memory>
 
 namespace meld {
@@ -8,10 +10,20 @@ namespace meld {
   class level_hierarchy;
   class level_id;
   class product_store;
+  class store_arena;
+
+  // Level IDs and product stores are reference-counted intrusively (as are end-of-message
+  // objects): each message copies its store pointer, and each store and level ID holds
+  // the pointer of its parent, without a separate std::shared_ptr control block.
+  void intrusive_ptr_add_ref(level_id const* id) noexcept;
+  void intrusive_ptr_release(level_id const* id) noexcept;
+  void intrusive_ptr_add_ref(product_store const* store) noexcept;
+  void intrusive_ptr_release(product_store const* store) noexcept;
 
-  using level_id_ptr = std::shared_ptr<level_id const>;
-  using product_store_const_ptr = std::shared_ptr<product_store const>;
-  using product_store_ptr = std::shared_ptr<product_store>;
+  using level_id_ptr = boost::intrusive_ptr<level_id const>;
+  using product_store_const_ptr = boost::intrusive_ptr<product_store const>;
+  using product_store_ptr = boost::intrusive_ptr<product_store>;
+  using store_arena_ptr = std::shared_ptr<store_arena>;
 
   enum class stage { process, flush };
 }
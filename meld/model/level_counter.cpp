@@ -5,6 +5,12 @@
 
 namespace meld {
 
+  product_key const& flush_counts_key()
+  {
+    static product_key const key{"[flush]"};
+    return key;
+  }
+
   flush_counts::flush_counts() = default;
 
   flush_counts::flush_counts(std::map<level_id::hash_type, std::size_t> child_counts) :
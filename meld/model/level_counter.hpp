@@ -3,6 +3,7 @@
 
 #include "meld/model/fwd.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/model/product_key.hpp"
 
 #include "oneapi/tbb/concurrent_hash_map.h"
 
@@ -35,6 +36,9 @@ namespace meld {
 
   using flush_counts_ptr = std::shared_ptr<flush_counts const>;
 
+  // Key for the flush_counts product carried by flush stores
+  product_key const& flush_counts_key();
+
   class level_counter {
   public:
     level_counter();
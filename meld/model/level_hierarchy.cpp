@@ -4,9 +4,19 @@
 #include "fmt/format.h"
 #include "spdlog/spdlog.h"
 
+#include <atomic>
+
 namespace {
   std::string const unnamed{"(unnamed)"};
   std::string const& maybe_name(std::string const& name) { return empty(name) ? unnamed : name; }
+
+  // Index of the counter incremented by the calling thread
+  std::size_t counter_index(std::size_t const n_counters)
+  {
+    static std::atomic<std::size_t> next_index{};
+    thread_local std::size_t const index = next_index.fetch_add(1, std::memory_order_relaxed);
+    return index % n_counters;
+  }
 }
 
 namespace meld {
@@ -15,19 +25,35 @@ namespace meld {
 
   void level_hierarchy::increment_count(level_id_ptr const& id)
   {
-    if (auto it = levels_.find(id->level_hash()); it != levels_.cend()) {
-      ++it->second->count;
-      return;
+    auto it = levels_.find(id->level_hash());
+    if (it == levels_.end()) {
+      it = register_level(id);
     }
+    auto& counts = it->second->counts;
+    counts[counter_index(size(counts))].value.fetch_add(1, std::memory_order_relaxed);
+  }
 
+  auto level_hierarchy::register_level(level_id_ptr const& id) -> levels_t::iterator
+  {
     auto const parent_hash = id->has_parent() ? id->parent()->level_hash() : -1ull;
-    // Warning: It can happen that two threads get to this location at the same time.  To
-    // guard against overwriting the value of "count", we use the returned iterator "it",
-    // which will either refer to the new node in the map, or to the already-emplaced
-    // node.  We then increment the count.
-    auto [it, _] = levels_.emplace(id->level_hash(),
-                                   std::make_shared<level_entry>(id->level_name(), parent_hash));
-    ++it->second->count;
+    // It can happen that two threads register the same level at the same time, in which
+    // case only one of the entries is emplaced.  Both threads then count in that entry.
+    return levels_
+      .emplace(id->level_hash(), std::make_shared<level_entry>(id->level_name(), parent_hash))
+      .first;
+  }
+
+  std::size_t level_hierarchy::total_count(std::size_t const level_hash) const
+  {
+    auto it = levels_.find(level_hash);
+    if (it == levels_.cend()) {
+      return 0;
+    }
+    std::size_t result{};
+    for (auto const& count : it->second->counts) {
+      result += count.value.load(std::memory_order_relaxed);
+    }
+    return result;
   }
 
   std::size_t level_hierarchy::count_for(std::string const& level_name) const
@@ -35,7 +61,7 @@ namespace meld {
     auto it = find_if(begin(levels_), end(levels_), [&level_name](auto const& level) {
       return level.second->name == level_name;
     });
-    return it != cend(levels_) ? it->second->count.load() : 0;
+    return it != cend(levels_) ? total_count(it->first) : 0;
   }
 
   void level_hierarchy::print() const { spdlog::info("{}", graph_layout()); }
@@ -54,9 +80,9 @@ namespace meld {
     for (std::size_t i = 0; auto const& [child_name, child_hash] : it->second) {
       bool const at_end = ++i == n;
       auto child_prefix = !at_end ? indent + " ├ " : indent + " └ ";
-      auto const& entry = *levels_.at(child_hash);
       result += "\n" + indent + " │ ";
-      result += fmt::format("\n{}{}: {}", child_prefix, maybe_name(child_name), entry.count);
+      result += fmt::format(
+        "\n{}{}: {}", child_prefix, maybe_name(child_name), total_count(child_hash));
 
       auto new_indent = indent;
       new_indent += at_end ? "   " : " │ ";
@@ -5,6 +5,9 @@
 
 #include "oneapi/tbb/concurrent_unordered_map.h"
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <utility>
@@ -12,6 +15,10 @@
 
 namespace meld {
 
+  // The instances of each level are counted in several counters, each on its own cache
+  // line, and each thread increments only one of them.  Counting (which happens whenever an
+  // end-of-message object is destroyed) therefore rarely contends on a shared counter.  The
+  // counters are summed when they are read, which may happen at any time.
   class level_hierarchy {
   public:
     ~level_hierarchy();
@@ -21,6 +28,11 @@ namespace meld {
     void print() const;
 
   private:
+    struct level_entry;
+    using levels_t = tbb::concurrent_unordered_map<std::size_t, std::shared_ptr<level_entry>>;
+
+    levels_t::iterator register_level(level_id_ptr const& id);
+    std::size_t total_count(std::size_t level_hash) const;
     std::string graph_layout() const;
 
     using hash_name_pair = std::pair<std::string, std::size_t>;
@@ -36,10 +48,13 @@ namespace meld {
 
       std::string name;
       std::size_t parent_hash;
-      std::atomic<std::size_t> count{};
+      struct alignas(64) counter {
+        std::atomic<std::size_t> value{};
+      };
+      std::array<counter, 16> counts;
     };
 
-    tbb::concurrent_unordered_map<std::size_t, std::shared_ptr<level_entry>> levels_;
+    levels_t levels_;
   };
 
 }
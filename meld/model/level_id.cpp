@@ -1,88 +1,159 @@
 #include "meld/model/level_id.hpp"
 #include "meld/utilities/hashing.hpp"
+#include "meld/utilities/interner.hpp"
 
 #include "boost/algorithm/string.hpp"
+#include "oneapi/tbb/concurrent_unordered_map.h"
 
 #include <algorithm>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <numeric>
 #include <stdexcept>
 
 namespace {
 
-  std::vector<std::size_t> all_numbers(meld::level_id const& id)
+  meld::interner<>& level_keys()
   {
-    if (!id.has_parent()) {
-      return {};
-    }
+    static meld::interner<> registry;
+    return registry;
+  }
 
-    auto const* current = &id;
-    std::vector<std::size_t> result(id.depth());
-    for (std::size_t i = id.depth(); i > 0; --i) {
-      result[i - 1] = current->number();
-      current = current->parent().get();
+  // The registry of level types is process-wide.  Entries are never removed, so the
+  // addresses of the level_type objects are stable.
+  class level_type_registry {
+  public:
+    meld::detail::level_type const* base() const noexcept { return &base_; }
+
+    meld::detail::level_type const* child_of(meld::detail::level_type const* parent,
+                                             std::string const& name)
+    {
+      auto const h = meld::hash(parent->hash, name);
+      if (auto it = types_.find(h); it != types_.cend()) {
+        return it->second.get();
+      }
+
+      std::lock_guard lock{mutex_};
+      if (auto it = types_.find(h); it != types_.cend()) {
+        return it->second.get();
+      }
+      meld::level_key const key{name};
+      auto lineage = parent->lineage;
+      lineage.push_back(key);
+      auto [it, _] = types_.emplace(h,
+                                    std::make_unique<meld::detail::level_type>(
+                                      meld::detail::level_type{
+                                        name, key, h, parent->depth + 1, parent, lineage}));
+      return it->second.get();
     }
-    return result;
+
+  private:
+    meld::detail::level_type const base_{
+      "job", meld::level_key{"job"}, meld::hash("job"), 0, nullptr, {meld::level_key{"job"}}};
+    std::mutex mutex_;
+    tbb::concurrent_unordered_map<std::size_t, std::unique_ptr<meld::detail::level_type const>>
+      types_;
+  };
+
+  level_type_registry& level_types()
+  {
+    static level_type_registry registry;
+    return registry;
   }
 
 }
 
 namespace meld {
 
-  level_id::level_id() : level_name_{"job"}, level_hash_{meld::hash(level_name_)} {}
+  level_key::level_key(std::string const& level_name) :
+    index_{level_keys().index_for(level_name)}
+  {
+  }
+
+  std::string const& level_key::name() const { return level_keys().value_for(index_); }
+
+  level_id::level_id(private_tag) : type_{level_types().base()} {}
 
-  level_id::level_id(level_id_ptr parent, std::size_t i, std::string level_name) :
+  level_id::level_id(private_tag,
+                     level_id_ptr parent,
+                     std::size_t const i,
+                     detail::level_type const* type) :
     parent_{std::move(parent)},
-    number_{i},
-    level_name_{std::move(level_name)},
-    level_hash_{meld::hash(parent_->level_hash_, level_name_)},
-    depth_{parent_->depth_ + 1},
-    hash_{meld::hash(parent_->hash_, number_, level_hash_)}
+    type_{type},
+    numbers_{parent_->numbers_},
+    ancestors_{parent_->ancestors_},
+    hash_{meld::hash(parent_->hash_, i, type_->hash)}
   {
     // FIXME: Should it be an error to create an ID with an empty name?
+    numbers_.push_back(i);
+    ancestors_.push_back(parent_.get());
+  }
+
+  level_id::level_id(level_id const& other) :
+    use_count_{1},
+    parent_{other.parent_},
+    type_{other.type_},
+    numbers_{other.numbers_},
+    ancestors_{other.ancestors_},
+    hash_{other.hash_}
+  {
+  }
+
+  level_id& level_id::operator=(level_id const& other)
+  {
+    parent_ = other.parent_;
+    type_ = other.type_;
+    numbers_ = other.numbers_;
+    ancestors_ = other.ancestors_;
+    hash_ = other.hash_;
+    return *this;
   }
 
   level_id const& level_id::base() { return *base_ptr(); }
   level_id_ptr level_id::base_ptr()
   {
-    static meld::level_id_ptr base_id{new level_id};
+    static meld::level_id_ptr base_id{new level_id{private_tag{}}};
     return base_id;
   }
 
-  std::string const& level_id::level_name() const noexcept { return level_name_; }
-  std::size_t level_id::depth() const noexcept { return depth_; }
+  std::string const& level_id::level_name() const noexcept { return type_->name; }
+  level_key level_id::level_name_key() const noexcept { return type_->key; }
+  std::size_t level_id::depth() const noexcept { return type_->depth; }
 
   level_id_ptr level_id::make_child(std::size_t const new_level_number,
-                                    std::string new_level_name) const
+                                    std::string const& new_level_name) const
   {
-    return level_id_ptr{
-      new level_id{shared_from_this(), new_level_number, std::move(new_level_name)}};
+    return level_id_ptr{new level_id{private_tag{},
+                                     level_id_ptr{this},
+                                     new_level_number,
+                                     level_types().child_of(type_, new_level_name)}};
   }
 
-  bool level_id::has_parent() const noexcept { return static_cast<bool>(parent_); }
-
-  std::size_t level_id::number() const { return number_; }
-  std::size_t level_id::hash() const noexcept { return hash_; }
-  std::size_t level_id::level_hash() const noexcept { return level_hash_; }
+  void intrusive_ptr_add_ref(level_id const* id) noexcept
+  {
+    id->use_count_.fetch_add(1, std::memory_order_relaxed);
+  }
 
-  bool level_id::operator==(level_id const& other) const
+  void intrusive_ptr_release(level_id const* id) noexcept
   {
-    if (depth_ != other.depth_)
-      return false;
-    auto const same_numbers = number_ == other.number_;
-    if (not parent_) {
-      return same_numbers;
+    if (id->use_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete id;
     }
-    return *parent_ == *other.parent_ && same_numbers;
   }
 
+  bool level_id::has_parent() const noexcept { return static_cast<bool>(parent_); }
+
+  std::size_t level_id::number() const { return numbers_.empty() ? -1ull : numbers_.back(); }
+  std::size_t level_id::hash() const noexcept { return hash_; }
+  std::size_t level_id::level_hash() const noexcept { return type_->hash; }
+
+  bool level_id::operator==(level_id const& other) const { return numbers_ == other.numbers_; }
+
   bool level_id::operator<(level_id const& other) const
   {
-    auto these_numbers = all_numbers(*this);
-    auto those_numbers = all_numbers(other);
     return std::lexicographical_compare(
-      begin(these_numbers), end(these_numbers), begin(those_numbers), end(those_numbers));
+      numbers_.begin(), numbers_.end(), other.numbers_.begin(), other.numbers_.end());
   }
 
   level_id_ptr id_for(std::vector<std::size_t> nums)
@@ -114,14 +185,28 @@ namespace meld {
 
   level_id_ptr level_id::parent(std::string const& level_name) const
   {
-    level_id_ptr parent = parent_;
-    while (parent) {
-      if (parent->level_name_ == level_name) {
-        return parent;
+    return parent(level_key{level_name});
+  }
+
+  level_id_ptr level_id::parent(level_key const key) const
+  {
+    auto const d = ancestor_depth(key);
+    if (d == -1ull) {
+      return nullptr;
+    }
+    return level_id_ptr{ancestors_[d]};
+  }
+
+  std::size_t level_id::ancestor_depth(level_key const key) const noexcept
+  {
+    // Search from the nearest ancestor upward; this ID's own level is excluded.
+    auto const& lineage = type_->lineage;
+    for (std::size_t d = depth(); d-- > 0ull;) {
+      if (lineage[d] == key) {
+        return d;
       }
-      parent = parent->parent_;
     }
-    return nullptr;
+    return -1ull;
   }
 
   std::string level_id::to_string() const
@@ -131,10 +216,10 @@ namespace meld {
     std::string result;
     std::string suffix{"]"};
 
-    if (number_ != -1ull) {
+    if (has_parent()) {
       result = to_string_this_level();
       auto parent = parent_;
-      while (parent != nullptr and parent->number_ != -1ull) {
+      while (parent != nullptr and parent->has_parent()) {
         result.insert(0, parent->to_string_this_level() + ", ");
         parent = parent->parent_;
       }
@@ -144,10 +229,10 @@ namespace meld {
 
   std::string level_id::to_string_this_level() const
   {
-    if (empty(level_name_)) {
-      return std::to_string(number_);
+    if (empty(level_name())) {
+      return std::to_string(number());
     }
-    return level_name_ + ":" + std::to_string(number_);
+    return level_name() + ":" + std::to_string(number());
   }
 
   std::ostream& operator<<(std::ostream& os, level_id const& id) { return os << id.to_string(); }
@@ -3,8 +3,11 @@
 
 #include "meld/model/fwd.hpp"
 
+#include "boost/container/small_vector.hpp"
 #include "fmt/format.h"
 
+#include <atomic>
+#include <compare>
 #include <cstddef>
 #include <initializer_list>
 #include <iosfwd>
@@ -14,17 +17,72 @@
 #include <vector>
 
 namespace meld {
-  class level_id : public std::enable_shared_from_this<level_id> {
+  // A level_key is an interned level name (e.g. "run" or "event").  Nodes resolve the
+  // level names they refer to once, so that ancestors can be looked up per message
+  // without comparing strings.
+  class level_key {
   public:
+    level_key() = default;
+    explicit level_key(std::string const& level_name);
+
+    std::size_t index() const noexcept { return index_; }
+    std::string const& name() const;
+    bool valid() const noexcept { return index_ != invalid_index; }
+
+    auto operator<=>(level_key const&) const = default;
+
+  private:
+    static constexpr std::size_t invalid_index{-1ull};
+    std::size_t index_{invalid_index};
+  };
+
+  namespace detail {
+    inline constexpr std::size_t inline_depth{6};
+
+    // One interned entry exists per level type (i.e. per distinct level_hash).
+    struct level_type {
+      std::string name;
+      level_key key;
+      std::size_t hash;
+      std::size_t depth;
+      level_type const* parent;
+      // Name keys of all level types from the top of the hierarchy down to this one
+      boost::container::small_vector<level_key, inline_depth> lineage;
+    };
+  }
+
+  class level_id {
+    // All level numbers (from the top of the hierarchy down to this level) are stored
+    // inline for hierarchies up to this depth.  Comparisons of IDs then do not require
+    // any allocations or walks up the parent chain.  The same holds for the table of
+    // ancestors, which makes looking up an ancestor by level name a constant-time
+    // operation.
+    using numbers_t = boost::container::small_vector<std::size_t, detail::inline_depth>;
+    using ancestors_t = boost::container::small_vector<level_id const*, detail::inline_depth>;
+    struct private_tag {
+      explicit private_tag() = default;
+    };
+
+  public:
+    // A copy is a plain value: it is not owned by a level_id_ptr, and references taken to
+    // it (e.g. by its children) never delete it.
+    level_id(level_id const& other);
+    level_id& operator=(level_id const& other);
+
     static level_id const& base();
     static level_id_ptr base_ptr();
 
     using hash_type = std::size_t;
-    level_id_ptr make_child(std::size_t new_level_number, std::string level_name) const;
+    level_id_ptr make_child(std::size_t new_level_number, std::string const& level_name) const;
     std::string const& level_name() const noexcept;
+    level_key level_name_key() const noexcept;
     std::size_t depth() const noexcept;
     level_id_ptr parent(std::string const& level_name) const;
+    level_id_ptr parent(level_key key) const;
     level_id_ptr parent() const noexcept;
+
+    // Depth of the nearest ancestor with the specified level name; -1 if there is none
+    std::size_t ancestor_depth(level_key key) const noexcept;
     bool has_parent() const noexcept;
     std::size_t number() const;
     std::size_t hash() const noexcept;
@@ -38,13 +96,20 @@ namespace meld {
     friend std::ostream& operator<<(std::ostream& os, level_id const& id);
 
   private:
-    level_id();
-    explicit level_id(level_id_ptr parent, std::size_t i, std::string level_name);
+    explicit level_id(private_tag);
+    explicit level_id(private_tag,
+                      level_id_ptr parent,
+                      std::size_t i,
+                      detail::level_type const* type);
+
+    friend void intrusive_ptr_add_ref(level_id const* id) noexcept;
+    friend void intrusive_ptr_release(level_id const* id) noexcept;
+
+    mutable std::atomic<std::size_t> use_count_{};
     level_id_ptr parent_{nullptr};
-    std::size_t number_{-1ull};
-    std::string level_name_;
-    std::size_t level_hash_;
-    std::size_t depth_{};
+    detail::level_type const* type_;
+    numbers_t numbers_{};
+    ancestors_t ancestors_{}; // Indexed by depth; does not include this ID
     hash_type hash_{0};
   };
 
@@ -0,0 +1,23 @@
+#include "meld/model/product_key.hpp"
+#include "meld/utilities/interner.hpp"
+
+#include <ostream>
+
+namespace {
+  meld::interner<>& registry()
+  {
+    static meld::interner<> r;
+    return r;
+  }
+}
+
+namespace meld {
+  product_key::product_key(char const* name) : product_key{std::string{name}} {}
+  product_key::product_key(std::string const& name) : index_{registry().index_for(name)} {}
+
+  std::string const& product_key::name() const { return registry().value_for(index_); }
+
+  std::size_t product_key::registered_keys() { return registry().size(); }
+
+  std::ostream& operator<<(std::ostream& os, product_key const& key) { return os << key.name(); }
+}
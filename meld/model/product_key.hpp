@@ -0,0 +1,40 @@
+#ifndef meld_model_product_key_hpp
+#define meld_model_product_key_hpp
+
+// =======================================================================================
+// A product_key is an interned product name.  The first time a given name is seen, it is
+// assigned a small integer by a process-wide registry; afterwards, comparing two keys is a
+// single integer comparison.  Framework nodes resolve the keys for their declared inputs
+// and outputs once (at the latest when the graph is finalized) so that no strings are
+// hashed or allocated when products are looked up for each message.
+// =======================================================================================
+
+#include <compare>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace meld {
+  class product_key {
+  public:
+    product_key() = default;
+    explicit product_key(char const* name);
+    explicit product_key(std::string const& name);
+
+    std::size_t index() const noexcept { return index_; }
+    std::string const& name() const;
+    bool valid() const noexcept { return index_ != invalid_index; }
+
+    auto operator<=>(product_key const&) const = default;
+
+    static std::size_t registered_keys();
+
+  private:
+    static constexpr std::size_t invalid_index{-1ull};
+    std::size_t index_{invalid_index};
+  };
+
+  std::ostream& operator<<(std::ostream& os, product_key const& key);
+}
+
+#endif // meld_model_product_key_hpp
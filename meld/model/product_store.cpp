@@ -1,6 +1,8 @@
 #include "meld/model/product_store.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/utilities/hashing.hpp"
 
+#include <iterator>
 #include <memory>
 #include <utility>
 
@@ -10,38 +12,49 @@ namespace meld {
                                level_id_ptr id,
                                std::string_view source,
                                stage processing_stage,
-                               products new_products) :
+                               products new_products,
+                               store_arena_ptr arena) :
     parent_{std::move(parent)},
-    products_{std::move(new_products)},
+    arena_{std::move(arena)},
+    products_{new_products.empty() ? products{arena_} : std::move(new_products)},
     id_{std::move(id)},
     source_{source},
     stage_{processing_stage}
   {
   }
 
-  product_store::product_store(product_store_const_ptr parent,
-                               std::size_t new_level_number,
-                               std::string const& new_level_name,
-                               std::string_view source,
-                               products new_products) :
-    parent_{parent},
-    products_{std::move(new_products)},
-    id_{parent->id()->make_child(new_level_number, new_level_name)},
-    source_{source},
-    stage_{stage::process}
+  template <typename... Args>
+  product_store_ptr product_store::create(store_arena_ptr const& arena, Args&&... args)
   {
+    arena_allocator<product_store> alloc{arena};
+    auto* mem = alloc.allocate(1);
+    product_store* store{};
+    try {
+      store = new (mem) product_store{std::forward<Args>(args)..., arena};
+    }
+    catch (...) {
+      alloc.deallocate(mem, 1);
+      throw;
+    }
+    return product_store_ptr{store};
   }
 
-  product_store::product_store(product_store_const_ptr parent,
-                               std::size_t new_level_number,
-                               std::string const& new_level_name,
-                               std::string_view source,
-                               stage processing_stage) :
-    parent_{parent},
-    id_{parent->id()->make_child(new_level_number, new_level_name)},
-    source_{source},
-    stage_{processing_stage}
+  void intrusive_ptr_add_ref(product_store const* store) noexcept
   {
+    store->use_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void intrusive_ptr_release(product_store const* store) noexcept
+  {
+    if (store->use_count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    // The allocator holds a reference to the arena, which therefore outlives the store
+    // until the store's memory has been returned to it.
+    arena_allocator<product_store> alloc{store->arena_};
+    auto* const p = const_cast<product_store*>(store);
+    std::destroy_at(p);
+    alloc.deallocate(p, 1);
   }
 
   product_store::~product_store() = default;
@@ -50,38 +63,51 @@ namespace meld {
 
   product_store_const_ptr product_store::parent(std::string const& level_name) const noexcept
   {
+    return parent(level_key{level_name});
+  }
+
+  product_store_const_ptr product_store::parent(level_key const key) const noexcept
+  {
+    // The level ID knows at which depth the ancestor lives; the store chain then only
+    // needs to be walked that many steps without comparing any level names.
+    auto const d = id_->ancestor_depth(key);
+    if (d == -1ull) {
+      return nullptr;
+    }
     auto store = parent_;
-    while (store != nullptr) {
-      if (store->level_name() == level_name) {
-        return store;
-      }
+    for (auto steps = id_->depth() - d; store != nullptr and steps > 1ull; --steps) {
       store = store->parent_;
     }
-    return nullptr;
+    return store;
   }
 
   product_store_const_ptr product_store::store_for_product(std::string const& product_name) const
   {
-    auto store = shared_from_this();
-    while (store != nullptr) {
-      if (store->contains_product(product_name)) {
-        return store;
+    return store_for_product(product_key{product_name});
+  }
+
+  product_store_const_ptr product_store::store_for_product(product_key const key) const
+  {
+    // Each store's own products are searched before those of its parent.
+    for (auto const* store = this; store != nullptr; store = store->parent_.get()) {
+      if (store->contains_product(key)) {
+        return product_store_const_ptr{store};
       }
-      store = store->parent_;
     }
     return nullptr;
   }
 
   product_store_ptr product_store::make_flush() const
   {
-    return product_store_ptr{new product_store{parent_, id_, "[inserted]", stage::flush}};
+    return create(arena_, parent_, id_, "[inserted]", stage::flush, products{});
   }
 
   product_store_ptr product_store::make_continuation(std::string_view source,
                                                      products new_products) const
   {
-    return product_store_ptr{
-      new product_store{parent_, id_, source, stage::process, std::move(new_products)}};
+    auto result = create(arena_, parent_, id_, source, stage::process, std::move(new_products));
+    result->early_release_ = early_release_;
+    return result;
   }
 
   product_store_ptr product_store::make_child(std::size_t new_level_number,
@@ -89,8 +115,14 @@ namespace meld {
                                               std::string_view source,
                                               products new_products)
   {
-    return product_store_ptr{new product_store{
-      shared_from_this(), new_level_number, new_level_name, source, std::move(new_products)}};
+    // Each new level instance receives its own arena, which is shared by its
+    // continuations and flush store.
+    return create(std::make_shared<store_arena>(),
+                  product_store_const_ptr{this},
+                  id_->make_child(new_level_number, new_level_name),
+                  source,
+                  stage::process,
+                  std::move(new_products));
   }
 
   product_store_ptr product_store::make_child(std::size_t new_level_number,
@@ -98,21 +130,63 @@ namespace meld {
                                               std::string_view source,
                                               stage processing_stage)
   {
-    return product_store_ptr{new product_store{
-      shared_from_this(), new_level_number, new_level_name, source, processing_stage}};
+    return create(std::make_shared<store_arena>(),
+                  product_store_const_ptr{this},
+                  id_->make_child(new_level_number, new_level_name),
+                  source,
+                  processing_stage,
+                  products{});
   }
 
   std::string const& product_store::level_name() const noexcept { return id_->level_name(); }
   std::string_view product_store::source() const noexcept { return source_; }
-  product_store_const_ptr product_store::parent() const noexcept { return parent_; }
+  product_store_const_ptr const& product_store::parent() const noexcept { return parent_; }
   level_id_ptr const& product_store::id() const noexcept { return id_; }
   bool product_store::is_flush() const noexcept { return stage_ == stage::flush; }
+  store_arena_ptr const& product_store::arena() const noexcept { return arena_; }
+
+  std::size_t product_store::shape_hash() const noexcept
+  {
+    if (auto const cached = shape_hash_.load(std::memory_order_relaxed)) {
+      return cached;
+    }
+    // Concurrent callers compute the same value, so either of their stores may win.
+    auto result = hash(parent_ ? parent_->shape_hash() : 0ull,
+                       id_->level_name_key().index(),
+                       static_cast<std::size_t>(std::ranges::distance(products_)));
+    for (auto const& [key, _] : products_) {
+      result = hash(result, key.index());
+    }
+    result += result == 0ull; // Zero is reserved for "not computed"
+    shape_hash_.store(result, std::memory_order_relaxed);
+    return result;
+  }
+
+  void product_store::enable_early_release() noexcept { early_release_ = true; }
+  bool product_store::early_release_enabled() const noexcept { return early_release_; }
+
+  void product_store::release_after_use(product_key const key, std::size_t const consumers) const
+  {
+    if (consumers == 0ull) {
+      return;
+    }
+    auto store = store_for_product(key);
+    if (not store or not store->early_release_) {
+      return;
+    }
+    store->products_.release_after_use(key, consumers);
+  }
 
   bool product_store::contains_product(std::string const& product_name) const
   {
     return products_.contains(product_name);
   }
 
+  bool product_store::contains_product(product_key const key) const noexcept
+  {
+    return products_.contains(key);
+  }
+
   product_store_ptr const& more_derived(product_store_ptr const& a, product_store_ptr const& b)
   {
     if (a->id()->depth() > b->id()->depth()) {
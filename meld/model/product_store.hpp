@@ -4,9 +4,12 @@
 #include "meld/model/fwd.hpp"
 #include "meld/model/handle.hpp"
 #include "meld/model/level_id.hpp"
+#include "meld/model/product_key.hpp"
 #include "meld/model/products.hpp"
+#include "meld/model/store_arena.hpp"
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -15,12 +18,13 @@
 
 namespace meld {
 
-  class product_store : public std::enable_shared_from_this<product_store> {
+  class product_store {
   public:
     ~product_store();
     static product_store_ptr base();
 
     product_store_const_ptr store_for_product(std::string const& product_name) const;
+    product_store_const_ptr store_for_product(product_key key) const;
 
     auto begin() const noexcept { return products_.begin(); }
     auto end() const noexcept { return products_.end(); }
@@ -28,7 +32,8 @@ namespace meld {
     std::string const& level_name() const noexcept;
     std::string_view source() const noexcept;
     product_store_const_ptr parent(std::string const& level_name) const noexcept;
-    product_store_const_ptr parent() const noexcept;
+    product_store_const_ptr parent(level_key key) const noexcept;
+    product_store_const_ptr const& parent() const noexcept;
     product_store_ptr make_flush() const;
     product_store_ptr make_continuation(std::string_view source, products new_products = {}) const;
     product_store_ptr make_child(std::size_t new_level_number,
@@ -41,16 +46,41 @@ namespace meld {
                                  stage st = stage::process);
     level_id_ptr const& id() const noexcept;
     bool is_flush() const noexcept;
+    store_arena_ptr const& arena() const noexcept;
+
+    // Hash of the level types and product keys of this store and of all its ancestors.  It
+    // is computed the first time it is requested--once the store has been filled and sent
+    // into the graph--and cached, so the products of the store and its ancestors must not
+    // change afterward.
+    std::size_t shape_hash() const noexcept;
+
+    // Early release of products
+    //
+    // A product may be released once all of its consumers have used it, provided that no
+    // store created later can read it through its parent chain.  The framework enables
+    // early release only for stores that are known to have no children; continuations
+    // inherit the setting.  The store that owns the product need not be this store--it
+    // may be any store in the parent chain.
+    void enable_early_release() noexcept;
+    bool early_release_enabled() const noexcept;
+    void release_after_use(product_key key, std::size_t consumers) const;
 
     // Product interface
     bool contains_product(std::string const& key) const;
+    bool contains_product(product_key key) const noexcept;
 
     template <typename T>
     T const& get_product(std::string const& key) const;
 
+    template <typename T>
+    T const& get_product(product_key key) const;
+
     template <typename T>
     handle<T> get_handle(std::string const& key) const;
 
+    template <typename T>
+    handle<T> get_handle(product_key key) const;
+
     // Thread-unsafe operations
     template <typename T>
     void add_product(std::string const& key, T&& t);
@@ -58,28 +88,47 @@ namespace meld {
     template <typename T>
     void add_product(std::string const& key, std::shared_ptr<product<T>>&& t);
 
+    template <typename T>
+    void add_product(product_key key, T&& t);
+
+    template <typename T>
+    void add_product(product_key key, std::shared_ptr<product<T>>&& t);
+
+    template <std::size_t N, typename Ts>
+    void add_products(std::array<product_key, N> const& keys, Ts&& ts);
+
+    // Constructs the product of type T in place from the specified arguments
+    template <typename T, typename... Args>
+    void emplace_product(std::string const& key, Args&&... args);
+
+    template <typename T, typename... Args>
+    void emplace_product(product_key key, Args&&... args);
+
   private:
     explicit product_store(product_store_const_ptr parent = nullptr,
                            level_id_ptr id = level_id::base_ptr(),
                            std::string_view source = {},
                            stage processing_stage = stage::process,
-                           products new_products = {});
-    explicit product_store(product_store_const_ptr parent,
-                           std::size_t new_level_number,
-                           std::string const& new_level_name,
-                           std::string_view source,
-                           products new_products);
-    explicit product_store(product_store_const_ptr parent,
-                           std::size_t new_level_number,
-                           std::string const& new_level_name,
-                           std::string_view source,
-                           stage processing_stage);
+                           products new_products = {},
+                           store_arena_ptr arena = nullptr);
+
+    // Creates a store whose memory, and the memory of its products, is allocated from the
+    // specified arena.
+    template <typename... Args>
+    static product_store_ptr create(store_arena_ptr const& arena, Args&&... args);
+
+    friend void intrusive_ptr_add_ref(product_store const* store) noexcept;
+    friend void intrusive_ptr_release(product_store const* store) noexcept;
 
+    mutable std::atomic<std::size_t> use_count_{};
+    mutable std::atomic<std::size_t> shape_hash_{}; // Zero until computed
     product_store_const_ptr parent_{nullptr};
+    store_arena_ptr arena_;
     products products_{};
     level_id_ptr id_;
     std::string_view source_;
     stage stage_;
+    bool early_release_{false};
   };
 
   product_store_ptr const& more_derived(product_store_ptr const& a, product_store_ptr const& b);
@@ -113,23 +162,65 @@ namespace meld {
   template <typename T>
   void product_store::add_product(std::string const& key, T&& t)
   {
-    add_product(key, std::make_shared<product<std::remove_cvref_t<T>>>(std::forward<T>(t)));
+    add_product(product_key{key}, std::forward<T>(t));
   }
 
   template <typename T>
   void product_store::add_product(std::string const& key, std::shared_ptr<product<T>>&& t)
+  {
+    add_product(product_key{key}, std::move(t));
+  }
+
+  template <typename T>
+  void product_store::add_product(product_key const key, T&& t)
+  {
+    add_product(key, std::make_shared<product<std::remove_cvref_t<T>>>(std::forward<T>(t)));
+  }
+
+  template <typename T>
+  void product_store::add_product(product_key const key, std::shared_ptr<product<T>>&& t)
   {
     products_.add(key, std::move(t));
   }
 
+  template <std::size_t N, typename Ts>
+  void product_store::add_products(std::array<product_key, N> const& keys, Ts&& ts)
+  {
+    products_.add_all(keys, std::forward<Ts>(ts));
+  }
+
+  template <typename T, typename... Args>
+  void product_store::emplace_product(std::string const& key, Args&&... args)
+  {
+    emplace_product<T>(product_key{key}, std::forward<Args>(args)...);
+  }
+
+  template <typename T, typename... Args>
+  void product_store::emplace_product(product_key const key, Args&&... args)
+  {
+    products_.emplace<T>(key, std::forward<Args>(args)...);
+  }
+
   template <typename T>
   [[nodiscard]] handle<T> product_store::get_handle(std::string const& key) const
+  {
+    return get_handle<T>(product_key{key});
+  }
+
+  template <typename T>
+  [[nodiscard]] handle<T> product_store::get_handle(product_key const key) const
   {
     return handle<T>{products_.get<T>(key), *id_};
   }
 
   template <typename T>
   [[nodiscard]] T const& product_store::get_product(std::string const& key) const
+  {
+    return get_product<T>(product_key{key});
+  }
+
+  template <typename T>
+  [[nodiscard]] T const& product_store::get_product(product_key const key) const
   {
     return *get_handle<T>(key);
   }
@@ -1,11 +1,75 @@
 #include "meld/model/products.hpp"
 
+#include <atomic>
 #include <string>
 
+namespace {
+  std::atomic<std::size_t> live_bytes{};
+  std::atomic<bool> sizes_reported{false};
+}
+
 namespace meld {
+  std::size_t live_product_bytes() noexcept { return live_bytes.load(std::memory_order_relaxed); }
+  bool product_sizes_reported() noexcept { return sizes_reported.load(std::memory_order_relaxed); }
+
+  void detail::add_product_bytes(std::size_t const bytes) noexcept
+  {
+    live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (not sizes_reported.load(std::memory_order_relaxed)) {
+      sizes_reported.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  void detail::remove_product_bytes(std::size_t const bytes) noexcept
+  {
+    live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  products::products(store_arena_ptr arena) : products_{arena_allocator<entry_t>{std::move(arena)}}
+  {
+  }
+
+  bool products::release_after_use(product_key const key, std::size_t const consumers) const
+  {
+    if (consumers == 0ull) {
+      return false;
+    }
+
+    auto it = find(key);
+    if (it == products_.end()) {
+      return false;
+    }
+
+    auto* const product = it->second.get();
+    if (not product or product->uses.fetch_add(1) + 1 != consumers) {
+      return false;
+    }
+
+    // This is the last counted consumer, so no other consumer reads the product anymore.
+    // Other readers of the collection (e.g. those that only check whether the product
+    // exists) may still access the slot, whose product pointer is therefore cleared
+    // atomically before the product is destroyed.
+    it->second.reset();
+    return true;
+  }
+
+  bool products::empty() const noexcept { return products_.empty(); }
+
   bool products::contains(std::string const& product_name) const
   {
-    return products_.contains(product_name);
+    return contains(product_key{product_name});
+  }
+
+  bool products::contains(product_key const key) const noexcept
+  {
+    return find(key) != products_.end();
+  }
+
+  products::const_iterator products::find(product_key const key) const noexcept
+  {
+    return std::find_if(products_.begin(), products_.end(), [key](auto const& entry) {
+      return entry.first == key;
+    });
   }
 
   products::const_iterator products::begin() const noexcept { return products_.begin(); }
@@ -2,50 +2,195 @@
 #define meld_model_products_hpp
 
 #include "meld/model/level_id.hpp"
+#include "meld/model/product_key.hpp"
 #include "meld/model/qualified_name.hpp"
+#include "meld/model/store_arena.hpp"
+#include "meld/model/type_id.hpp"
 
-#include "boost/core/demangle.hpp"
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
 #include <memory>
 #include <string>
-#include <typeindex>
-#include <unordered_map>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace meld {
 
   struct product_base {
+    explicit product_base(type_id t) : type{t} {}
     virtual ~product_base() = default;
     virtual void const* address() const = 0;
-    virtual std::type_index type() const = 0;
+
+    // Registered by the shared object that created the product
+    type_id const type;
+
+    // Number of consumers that have finished using the product (see
+    // products::release_after_use).
+    std::atomic<std::size_t> uses{};
   };
 
+  // A size hook reports the number of bytes held by a product of type T.  It is provided
+  // by specializing product_size with a call operator:
+  //
+  //   template <>
+  //   struct meld::product_size<hits> {
+  //     std::size_t operator()(hits const& h) const { return h.size() * sizeof(hit); }
+  //   };
+  //
+  // The sizes of all live products whose types have size hooks are summed by
+  // live_product_bytes(), which the framework uses to enforce a memory budget.
+  template <typename T>
+  struct product_size {};
+
+  template <typename T>
+  concept has_size_hook = requires(T const& t) {
+    { product_size<T>{}(t) } -> std::convertible_to<std::size_t>;
+  };
+
+  // Number of bytes held by live products whose types have size hooks
+  std::size_t live_product_bytes() noexcept;
+
+  // Whether any product with a size hook has been created
+  bool product_sizes_reported() noexcept;
+
+  namespace detail {
+    void add_product_bytes(std::size_t bytes) noexcept;
+    void remove_product_bytes(std::size_t bytes) noexcept;
+  }
+
   template <typename T>
   struct product : product_base {
-    explicit product(T const& prod) : obj{prod} {}
+    explicit product(T const& prod) : product_base{type_id_for<T>()}, obj{prod} { add_size(); }
+    explicit product(T&& prod) : product_base{type_id_for<T>()}, obj{std::move(prod)}
+    {
+      add_size();
+    }
+
+    template <typename... Args>
+    explicit product(std::in_place_t, Args&&... args) :
+      product_base{type_id_for<T>()}, obj(std::forward<Args>(args)...)
+    {
+      add_size();
+    }
+
+    ~product()
+    {
+      if constexpr (has_size_hook<value_type>) {
+        detail::remove_product_bytes(size);
+      }
+    }
+
     void const* address() const final { return &obj; }
-    virtual std::type_index type() const { return std::type_index{typeid(T)}; }
-    std::remove_cvref_t<T> obj;
+
+    using value_type = std::remove_cvref_t<T>;
+    value_type obj;
+    std::size_t size{}; // Reported by the size hook, if any
+
+  private:
+    void add_size()
+    {
+      if constexpr (has_size_hook<value_type>) {
+        size = product_size<value_type>{}(obj);
+        detail::add_product_bytes(size);
+      }
+    }
+  };
+
+  template <std::size_t N>
+  std::array<product_key, N> to_product_keys(std::array<qualified_name, N> const& names)
+  {
+    std::array<product_key, N> result;
+    std::ranges::transform(
+      names, result.begin(), [](qualified_name const& name) { return product_key{name.name()}; });
+    return result;
+  }
+
+  // A product slot is read concurrently by the consumers of a store, and it is cleared by
+  // the last of the consumers once the product has been used (see
+  // products::release_after_use).  Readers only load the raw product pointer, which is
+  // atomic; the owning pointer is touched solely by the one consumer that releases the
+  // product, as determined by the product's use count.
+  class product_slot {
+  public:
+    product_slot(std::shared_ptr<product_base> product) noexcept :
+      owner_{std::move(product)}, ptr_{owner_.get()}
+    {
+    }
+
+    // Slots are moved only while their collection is being filled, before the collection
+    // is shared with other threads.
+    product_slot(product_slot&& other) noexcept :
+      owner_{std::move(other.owner_)}, ptr_{other.ptr_.exchange(nullptr)}
+    {
+    }
+    product_slot& operator=(product_slot&& other) noexcept
+    {
+      owner_ = std::move(other.owner_);
+      ptr_.store(other.ptr_.exchange(nullptr));
+      return *this;
+    }
+
+    product_base* get() const noexcept { return ptr_.load(std::memory_order_acquire); }
+    void reset() const noexcept
+    {
+      ptr_.store(nullptr, std::memory_order_release);
+      owner_.reset();
+    }
+
+  private:
+    mutable std::shared_ptr<product_base> owner_;
+    mutable std::atomic<product_base*> ptr_;
   };
 
   class products {
-    using collection_t = std::unordered_map<std::string, std::shared_ptr<product_base>>;
+    // A store typically holds only a handful of products.  They are therefore kept in a
+    // flat vector, which is searched by comparing the interned product keys.
+    using entry_t = std::pair<product_key, product_slot>;
+    using collection_t = std::vector<entry_t, arena_allocator<entry_t>>;
 
   public:
     using const_iterator = collection_t::const_iterator;
 
+    products() = default;
+    explicit products(store_arena_ptr arena);
+
     template <typename T>
     void add(std::string const& product_name, T&& t)
     {
-      add(product_name, std::make_shared<product<std::remove_cvref_t<T>>>(std::forward<T>(t)));
+      add(product_key{product_name}, std::forward<T>(t));
     }
 
     template <typename T>
-    void add(std::string const& product_name, std::shared_ptr<product<T>>&& t)
+    void add(product_key const key, T&& t)
+    {
+      using product_t = product<std::remove_cvref_t<T>>;
+      add(key,
+          std::allocate_shared<product_t>(arena_allocator<product_t>{products_.get_allocator()},
+                                          std::forward<T>(t)));
+    }
+
+    template <typename T, typename... Args>
+    void emplace(product_key const key, Args&&... args)
     {
-      products_.emplace(product_name, std::move(t));
+      add(key,
+          std::allocate_shared<product<T>>(arena_allocator<product<T>>{products_.get_allocator()},
+                                           std::in_place,
+                                           std::forward<Args>(args)...));
+    }
+
+    template <typename T>
+    void add(product_key const key, std::shared_ptr<product<T>>&& t)
+    {
+      if (contains(key)) {
+        return;
+      }
+      products_.emplace_back(key, std::move(t));
     }
 
     template <typename Ts>
@@ -57,17 +202,38 @@ namespace meld {
     template <typename... Ts>
     void add_all(std::array<qualified_name, sizeof...(Ts)> names, std::tuple<Ts...> ts)
     {
-      [this, &names]<std::size_t... Is>(auto const& ts, std::index_sequence<Is...>) {
-        (this->add(names[Is].name(), std::get<Is>(ts)), ...);
-      }(ts, std::index_sequence_for<Ts...>{});
+      [this, &names]<std::size_t... Is>(auto&& ts, std::index_sequence<Is...>) {
+        (this->add(names[Is].name(), std::get<Is>(std::move(ts))), ...);
+      }(std::move(ts), std::index_sequence_for<Ts...>{});
+    }
+
+    template <typename Ts>
+    void add_all(std::array<product_key, 1> const& keys, Ts&& ts)
+    {
+      add(keys[0], std::forward<Ts>(ts));
+    }
+
+    template <typename... Ts>
+    void add_all(std::array<product_key, sizeof...(Ts)> const& keys, std::tuple<Ts...> ts)
+    {
+      // Each element of the (by-value) tuple is moved into its product.
+      [this, &keys]<std::size_t... Is>(auto&& ts, std::index_sequence<Is...>) {
+        (this->add(keys[Is], std::get<Is>(std::move(ts))), ...);
+      }(std::move(ts), std::index_sequence_for<Ts...>{});
     }
 
     template <typename T>
     std::variant<T const*, std::string> get(std::string const& product_name) const
     {
-      auto it = products_.find(product_name);
+      return get<T>(product_key{product_name});
+    }
+
+    template <typename T>
+    std::variant<T const*, std::string> get(product_key const key) const
+    {
+      auto it = find(key);
       if (it == cend(products_)) {
-        return "No product exists with the name '" + product_name + "'.";
+        return "No product exists with the name '" + key.name() + "'.";
       }
 
       // Should be able to use dynamic_cast a la:
@@ -77,22 +243,37 @@ namespace meld {
       //   }
       //
       // Unfortunately, this doesn't work well whenever products are inserted across
-      // modules and shared object libraries.
+      // modules and shared object libraries.  The registered type IDs are used instead.
 
-      auto available_product = it->second.get();
-      if (std::strcmp(typeid(T).name(), available_product->type().name()) == 0) {
+      auto const* available_product = it->second.get();
+      if (available_product == nullptr) {
+        return "Product '" + key.name() + "' has already been released by its consumers.";
+      }
+      auto const requested_type = type_id_for<T>();
+      if (requested_type == available_product->type) {
         return &reinterpret_cast<product<T> const*>(available_product)->obj;
       }
-      return "Cannot get product '" + product_name + "' with type '" +
-             boost::core::demangle(typeid(T).name()) + "' -- must specify type '" +
-             boost::core::demangle(available_product->type().name()) + "'.";
+      return "Cannot get product '" + key.name() + "' with type '" + requested_type.name() +
+             "' -- must specify type '" + available_product->type.name() + "'.";
     }
 
+    // Records that one of the specified number of consumers has finished using the
+    // product.  Once all of them have done so, the product is destroyed, but its key
+    // remains in the collection.  Releasing a product does not change what any remaining
+    // reader can observe, so it is permitted on a const collection.  A 'consumers' value
+    // of zero means that the product is never released.  Returns true if the product was
+    // released by this call.
+    bool release_after_use(product_key key, std::size_t consumers) const;
+
+    bool empty() const noexcept;
     bool contains(std::string const& product_name) const;
+    bool contains(product_key key) const noexcept;
     const_iterator begin() const noexcept;
     const_iterator end() const noexcept;
 
   private:
+    const_iterator find(product_key key) const noexcept;
+
     collection_t products_;
   };
 }
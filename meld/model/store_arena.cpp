@@ -0,0 +1,17 @@
+#include "meld/model/store_arena.hpp"
+
+#include <mutex>
+
+namespace meld {
+
+  store_arena::store_arena() : resource_{initial_buffer_.data(), initial_buffer_.size()} {}
+
+  void* store_arena::allocate(std::size_t const bytes, std::size_t const alignment)
+  {
+    // Stores of the same level instance can be created concurrently (e.g. by transforms
+    // that run in parallel), but contention on any single arena is expected to be low.
+    std::lock_guard lock{mutex_};
+    return resource_.allocate(bytes, alignment);
+  }
+
+}
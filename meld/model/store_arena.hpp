@@ -0,0 +1,90 @@
+#ifndef meld_model_store_arena_hpp
+#define meld_model_store_arena_hpp
+
+// =======================================================================================
+// The store_arena class is a monotonic memory resource that is shared by all product
+// stores that belong to a given level instance (e.g. one event): the store itself, its
+// continuations and flush store, its product-collection storage, and the product
+// payloads.  Individual deallocations are no-ops; the memory is released wholesale once
+// the last object allocated from the arena has been destroyed.
+//
+// Each arena_allocator holds a reference to its arena, so an arena outlives every object
+// allocated from it--including the control blocks of shared pointers created with
+// std::allocate_shared.  An arena_allocator without an arena falls back to the global
+// operator new and delete.
+// =======================================================================================
+
+#include "meld/model/fwd.hpp"
+
+#include "oneapi/tbb/spin_mutex.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+
+namespace meld {
+
+  class store_arena {
+  public:
+    store_arena();
+
+    store_arena(store_arena const&) = delete;
+    store_arena& operator=(store_arena const&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t alignment);
+
+  private:
+    static constexpr std::size_t initial_size{1024};
+    alignas(std::max_align_t) std::array<std::byte, initial_size> initial_buffer_;
+    tbb::spin_mutex mutex_;
+    std::pmr::monotonic_buffer_resource resource_;
+  };
+
+  template <typename T>
+  class arena_allocator {
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    arena_allocator() = default;
+    explicit arena_allocator(store_arena_ptr arena) noexcept : arena_{std::move(arena)} {}
+
+    template <typename U>
+    arena_allocator(arena_allocator<U> const& other) noexcept : arena_{other.arena()}
+    {
+    }
+
+    T* allocate(std::size_t const n)
+    {
+      if (arena_) {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+      }
+      return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t const n) noexcept
+    {
+      if (not arena_) {
+        std::allocator<T>{}.deallocate(p, n);
+      }
+    }
+
+    store_arena_ptr const& arena() const noexcept { return arena_; }
+
+    template <typename U>
+    bool operator==(arena_allocator<U> const& other) const noexcept
+    {
+      return arena_ == other.arena();
+    }
+
+  private:
+    store_arena_ptr arena_{};
+  };
+
+}
+
+#endif // meld_model_store_arena_hpp
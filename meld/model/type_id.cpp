@@ -0,0 +1,28 @@
+#include "meld/model/type_id.hpp"
+#include "meld/utilities/interner.hpp"
+
+#include "boost/core/demangle.hpp"
+
+#include <string>
+
+namespace {
+  // Types are registered by their mangled names; the demangled name is stored.
+  meld::interner<>& registry()
+  {
+    static meld::interner<> r;
+    return r;
+  }
+}
+
+namespace meld {
+  type_id::type_id(std::type_info const& info) :
+    index_{registry().index_for(info.name(), [](std::string const& mangled_name) {
+      return boost::core::demangle(mangled_name.c_str());
+    })}
+  {
+  }
+
+  std::string const& type_id::name() const { return registry().value_for(index_); }
+
+  std::size_t type_id::registered_types() { return registry().size(); }
+}
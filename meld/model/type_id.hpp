@@ -0,0 +1,50 @@
+#ifndef meld_model_type_id_hpp
+#define meld_model_type_id_hpp
+
+// =======================================================================================
+// A type_id is a process-wide integer identifier for a product type.  Comparing
+// std::type_info objects (or dynamic_cast) is not reliable across shared-object
+// boundaries, so product types are instead registered by their mangled names, which
+// agree across plugins.  Each type is registered once per shared object (see
+// type_id_for); afterwards, checking the type of a product is a single integer
+// comparison.  The same identifiers are used to check that the types of products
+// produced and consumed by framework nodes agree when the graph is finalized.
+// =======================================================================================
+
+#include <compare>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace meld {
+  class type_id {
+  public:
+    type_id() = default;
+    explicit type_id(std::type_info const& info);
+
+    std::size_t index() const noexcept { return index_; }
+    std::string const& name() const; // Demangled
+    bool valid() const noexcept { return index_ != invalid_index; }
+
+    auto operator<=>(type_id const&) const = default;
+
+    static std::size_t registered_types();
+
+  private:
+    static constexpr std::size_t invalid_index{-1ull};
+    std::size_t index_{invalid_index};
+  };
+
+  using type_ids = std::vector<type_id>;
+
+  template <typename T>
+  type_id type_id_for()
+  {
+    static type_id const id{typeid(std::remove_cvref_t<T>)};
+    return id;
+  }
+}
+
+#endif // meld_model_type_id_hpp
@@ -0,0 +1,77 @@
+#ifndef meld_utilities_interner_hpp
+#define meld_utilities_interner_hpp
+
+// =======================================================================================
+// An interner assigns a dense index to each distinct name (e.g. a product or level name),
+// so that names can be compared and hashed as integers.  The value stored for a name is
+// created when the name is first registered; by default it is the name itself.  Entries
+// are never removed, so references to stored values remain valid.
+//
+// Looking up a registered name takes no lock.  Registering a new name takes a lock,
+// which ensures that only one index is assigned per name.
+// =======================================================================================
+
+#include "oneapi/tbb/concurrent_unordered_map.h"
+#include "oneapi/tbb/concurrent_vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace meld {
+  template <typename Value = std::string>
+  class interner {
+  public:
+    // Returns the index for the name, registering the name if necessary
+    std::size_t index_for(std::string const& name)
+    {
+      return index_for(name, [](std::string const& n) { return Value{n}; });
+    }
+
+    // Returns the index for the name; if the name is not yet registered, the value stored
+    // for it is 'make_value(name)'.
+    template <typename F>
+    std::size_t index_for(std::string const& name, F make_value)
+    {
+      if (auto index = find(name)) {
+        return *index;
+      }
+
+      std::lock_guard lock{mutex_};
+      if (auto index = find(name)) {
+        return *index;
+      }
+      auto const index =
+        static_cast<std::size_t>(values_.push_back(make_value(name)) - values_.begin());
+      indices_.emplace(name, index);
+      return index;
+    }
+
+    // Returns the index for the name without registering it
+    std::optional<std::size_t> find(std::string const& name) const
+    {
+      if (auto it = indices_.find(name); it != indices_.cend()) {
+        return it->second;
+      }
+      return std::nullopt;
+    }
+
+    Value const& value_for(std::size_t const index) const
+    {
+      assert(index < values_.size());
+      return values_[index];
+    }
+
+    std::size_t size() const { return values_.size(); }
+
+  private:
+    std::mutex mutex_;
+    tbb::concurrent_unordered_map<std::string, std::size_t> indices_;
+    tbb::concurrent_vector<Value> values_;
+  };
+}
+
+#endif // meld_utilities_interner_hpp
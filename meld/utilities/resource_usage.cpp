@@ -3,6 +3,9 @@
 #include "spdlog/spdlog.h"
 
 #include <sys/resource.h>
+#include <unistd.h>
+
+#include <fstream>
 
 using namespace std::chrono;
 
@@ -33,6 +36,20 @@ namespace meld {
   {
   }
 
+  std::size_t resource_usage::current_rss() noexcept
+  {
+#if __linux__
+    // The second field of /proc/self/statm is the number of resident pages.
+    std::ifstream statm{"/proc/self/statm"};
+    std::size_t total_pages{}, resident_pages{};
+    if (statm >> total_pages >> resident_pages) {
+      return resident_pages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    // Otherwise, the maximum RSS is the best available estimate.
+    return static_cast<std::size_t>(get_rusage().max_rss * 1e6);
+  }
+
   resource_usage::~resource_usage()
   {
     auto const [elapsed_time, max_rss] = get_rusage();
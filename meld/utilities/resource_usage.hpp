@@ -4,9 +4,11 @@
 // =======================================================================================
 // The resource_usage class tracks the CPU time and real time during the lifetime of a
 // resource_usage object.  The destructor will also report the maximum RSS of the process.
+// The current RSS can be sampled at any time with resource_usage::current_rss().
 // =======================================================================================
 
 #include <chrono>
+#include <cstddef>
 
 namespace meld {
   class resource_usage {
@@ -14,6 +16,9 @@ namespace meld {
     resource_usage() noexcept;
     ~resource_usage();
 
+    // Current resident set size of the process in bytes
+    static std::size_t current_rss() noexcept;
+
   private:
     std::chrono::time_point<std::chrono::steady_clock> begin_wall_;
     double begin_cpu_;
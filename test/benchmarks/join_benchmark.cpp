@@ -0,0 +1,109 @@
+// =======================================================================================
+// Microbenchmark comparing meld's message_join with TBB's tag-matching join_node, which
+// multi-input nodes previously used.  For each number of inputs (2, 4 and 8) and each
+// thread count, the messages for all IDs are delivered to the join ports from a
+// parallel loop, and the time until every joined tuple has been received is reported.
+//
+// Usage: join_benchmark [number of message IDs] [maximum number of threads]
+// =======================================================================================
+
+#include "meld/core/message.hpp"
+
+#include "fmt/format.h"
+#include "oneapi/tbb/flow_graph.h"
+#include "oneapi/tbb/global_control.h"
+#include "oneapi/tbb/info.h"
+#include "oneapi/tbb/parallel_for.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace meld;
+using namespace std::chrono;
+
+namespace {
+  template <std::size_t N, typename Join>
+  std::vector<tbb::flow::receiver<message>*> ports_of(Join& join)
+  {
+    return [&join]<std::size_t... Is>(
+             std::index_sequence<Is...>) -> std::vector<tbb::flow::receiver<message>*> {
+      return {&tbb::flow::input_port<Is>(join)...};
+    }(std::make_index_sequence<N>{});
+  }
+
+  template <typename Join, std::size_t N>
+  double time_join(std::size_t const n_ids, Join& join, tbb::flow::graph& g)
+  {
+    std::atomic<std::size_t> joined{};
+    tbb::flow::function_node<messages_t<N>> sink{
+      g, tbb::flow::unlimited, [&joined](messages_t<N> const&) { ++joined; }};
+    make_edge(join, sink);
+
+    auto const ports = ports_of<N>(join);
+    auto const start = steady_clock::now();
+    tbb::parallel_for(std::size_t{}, n_ids * N, [&ports, n_ids](std::size_t const i) {
+      // Deliver the messages for each port in separate passes over the IDs so that many
+      // IDs are pending at once.
+      auto const id = i % n_ids + 1ull;
+      ports[i / n_ids]->try_put(message{nullptr, nullptr, id});
+    });
+    g.wait_for_all();
+    auto const elapsed = duration_cast<duration<double, std::milli>>(steady_clock::now() - start);
+
+    if (joined != n_ids) {
+      fmt::print(stderr, "Expected {} joined tuples, received {}.\n", n_ids, joined.load());
+      std::exit(1);
+    }
+    return elapsed.count();
+  }
+
+  template <std::size_t N>
+  void compare(std::size_t const n_ids, std::size_t const threads)
+  {
+    tbb::global_control const control{tbb::global_control::max_allowed_parallelism, threads};
+
+    double meld_ms{};
+    {
+      tbb::flow::graph g;
+      auto join = make_join_or_none(g, std::make_index_sequence<N>{});
+      meld_ms = time_join<decltype(join), N>(n_ids, join, g);
+    }
+
+    double tbb_ms{};
+    {
+      tbb::flow::graph g;
+      auto join = [&g]<std::size_t... Is>(std::index_sequence<Is...>) {
+        return detail::tag_matching_join_t<N>{g, type_t<MessageHasher, Is>{}...};
+      }(std::make_index_sequence<N>{});
+      tbb_ms = time_join<decltype(join), N>(n_ids, join, g);
+    }
+
+    fmt::print("{:>6} {:>8} {:>14.2f} {:>14.2f} {:>8.2f}\n",
+               N,
+               threads,
+               meld_ms,
+               tbb_ms,
+               tbb_ms / meld_ms);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::size_t const n_ids = argc > 1 ? std::stoull(argv[1]) : 100'000ull;
+  std::size_t const max_threads =
+    argc > 2 ? std::stoull(argv[2]) : static_cast<std::size_t>(tbb::info::default_concurrency());
+
+  fmt::print("Joining {} message IDs\n\n", n_ids);
+  fmt::print(
+    "{:>6} {:>8} {:>14} {:>14} {:>8}\n", "Inputs", "Threads", "meld (ms)", "TBB (ms)", "Speedup");
+  for (std::size_t threads = 1ull; threads <= max_threads; threads *= 2ull) {
+    compare<2>(n_ids, threads);
+    compare<4>(n_ids, threads);
+    compare<8>(n_ids, threads);
+  }
+}
@@ -52,4 +52,17 @@ TEST_CASE("Cached product stores", "[data model]")
     // Make sure both stores have the same parent
     CHECK(store2->parent() == store1->parent());
   }
+
+  SECTION("Passed levels are evicted")
+  {
+    auto store123 = stores.get_store("1:2:3"_id);
+    CHECK(stores.size() == 4ull);
+    auto store124 = stores.get_store("1:2:4"_id);
+    CHECK(stores.size() == 4ull);
+    CHECK(store123->parent() == store124->parent());
+
+    auto store2 = stores.get_store("2"_id);
+    CHECK(stores.size() == 2ull);
+    CHECK(store2->parent() == store123->parent()->parent()->parent());
+  }
 }
@@ -0,0 +1,110 @@
+// =======================================================================================
+/*
+   This test verifies that products of level instances without children are released as
+   soon as all of their consumers have used them.  The graph is:
+
+                    Multiplexer
+                     /       \
+               count_digits   \
+                    |          \
+               check_hits    check_calibration
+
+   The "digits" products are created by the source for each event and consumed only by
+   count_digits.  The "calibration" product belongs to the job, whose events may read it,
+   and is therefore never released early.
+*/
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+#include "test/products_for_output.hpp"
+
+#include "catch2/catch_all.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  std::atomic<int> live_digits{};
+
+  struct digits {
+    explicit digits(std::size_t n) : values(n) { ++live_digits; }
+    digits(digits const& other) : values{other.values} { ++live_digits; }
+    ~digits() { --live_digits; }
+    std::vector<int> values;
+  };
+
+  std::size_t count_digits(digits const& d) { return d.values.size(); }
+  void check_hits(std::size_t hits) { CHECK(hits == 100u); }
+  void check_calibration(double calibration) { CHECK(calibration == 1.5); }
+
+  constexpr unsigned max_events{10u};
+
+  framework_graph make_graph()
+  {
+    std::vector<level_id_ptr> levels;
+    levels.reserve(max_events + 1u);
+    levels.push_back(level_id::base_ptr());
+    for (unsigned i = 0u; i != max_events; ++i) {
+      levels.push_back(levels.front()->make_child(i, "event"));
+    }
+
+    return framework_graph{
+      [levels, i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+        if (i == levels.size()) {
+          return nullptr;
+        }
+        auto store = cached_stores.get_store(levels[i++]);
+        if (store->level_name() == "event") {
+          store->emplace_product<digits>("digits", 100u);
+        }
+        else {
+          store->add_product("calibration", 1.5);
+        }
+        return store;
+      }};
+  }
+}
+
+TEST_CASE("Release products after their last consumer", "[graph]")
+{
+  auto g = make_graph();
+  g.with(count_digits, concurrency::unlimited).transform("digits").to("hits");
+  g.with(check_hits, concurrency::unlimited).monitor("hits");
+  g.with(check_calibration, concurrency::unlimited).monitor("calibration");
+
+  SECTION("Without outputs")
+  {
+    g.execute("early_release_t");
+    CHECK(g.execution_counts("count_digits") == max_events);
+    // The last event store is still cached by the framework, but its digits have been
+    // released.
+    CHECK(live_digits == 0);
+  }
+
+  SECTION("With an output")
+  {
+    g.make<test::products_for_output>().output_with(&test::products_for_output::save,
+                                                    concurrency::unlimited);
+    g.execute();
+    CHECK(g.execution_counts("check_hits") == max_events);
+    CHECK(live_digits == 0);
+  }
+
+  SECTION("With an output that retains products")
+  {
+    g.make<test::products_for_output>()
+      .output_with(&test::products_for_output::save, concurrency::unlimited)
+      .retain_products();
+    g.execute();
+    CHECK(g.execution_counts("check_hits") == max_events);
+    // Retained digits are released only once their stores are evicted from the cache of
+    // product stores; only the last event store is still cached.
+    CHECK(live_digits == 1);
+  }
+}
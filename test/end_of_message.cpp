@@ -0,0 +1,51 @@
+#include "meld/core/end_of_message.hpp"
+#include "meld/model/level_id.hpp"
+
+#include "catch2/catch_all.hpp"
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  std::vector<end_of_message_ptr> make_eoms(std::size_t const n)
+  {
+    std::vector<end_of_message_ptr> result;
+    result.reserve(n);
+    for (std::size_t i = 0; i != n; ++i) {
+      result.push_back(end_of_message::make_base(nullptr, level_id::base_ptr()));
+    }
+    return result;
+  }
+}
+
+TEST_CASE("End-of-message objects freed by other threads", "[memory]")
+{
+  constexpr std::size_t n_rounds{10};
+  constexpr std::size_t n_eoms{1000};
+  for (std::size_t i = 0; i != n_rounds; ++i) {
+    std::vector<end_of_message_ptr> eoms;
+    std::thread{[&eoms] { eoms = make_eoms(n_eoms); }}.join();
+    std::thread{[&eoms] {
+      eoms.clear();
+      // Memory freed by this thread is reused by its next allocations.
+      auto reused = make_eoms(n_eoms);
+    }}.join();
+  }
+  CHECK(make_eoms(n_eoms).size() == n_eoms);
+}
+
+TEST_CASE("End-of-message objects freed during thread exit", "[memory]")
+{
+  std::vector<end_of_message_ptr> eoms;
+  std::thread{[&eoms] {
+    // Constructed before the thread's cache is first used, and thus destroyed after it.
+    thread_local std::vector<end_of_message_ptr> held;
+    held = make_eoms(500);
+    eoms = make_eoms(500);
+  }}.join();
+  CHECK(eoms.size() == 500ull);
+  eoms.clear();
+}
@@ -4,6 +4,10 @@
 #include "catch2/catch_all.hpp"
 #include "oneapi/tbb/concurrent_vector.h"
 
+#include <fstream>
+#include <iterator>
+#include <string>
+
 using namespace meld;
 using namespace oneapi::tbb;
 
@@ -35,6 +39,9 @@ namespace {
 
   constexpr bool evens_only(unsigned int const value) { return value % 2u == 0u; }
   constexpr bool odds_only(unsigned int const value) { return not evens_only(value); }
+  constexpr unsigned int square(unsigned int const value) { return value * value; }
+  constexpr unsigned int add_one(unsigned int const value) { return value + 1u; }
+  void ignore_number(unsigned int) {}
 
   // Hacky!
   struct sum_numbers {
@@ -177,3 +184,74 @@ TEST_CASE("Two predicates in parallel (each with multiple arguments)", "[filteri
 
   g.execute("two_predicates_in_parallel_multiarg_t");
 }
+
+TEST_CASE("Short-circuit predicate evaluation", "[filtering]")
+{
+  framework_graph g{[src = source{10u}]() mutable { return src.next(); }};
+  g.evaluate_predicates(predicate_evaluation::short_circuit);
+  g.make<not_in_range>(0u, 4u)
+    .with("exclude_0_to_4", &not_in_range::eval, concurrency::unlimited)
+    .evaluate("num")
+    .cost(100.);
+  g.with(evens_only, concurrency::unlimited).evaluate("num").cost(1.);
+
+  auto const expected_numbers = {4u, 6u, 8u};
+  g.make<collect_numbers>(expected_numbers)
+    .with("collect_evens", &collect_numbers::collect, concurrency::unlimited)
+    .when("exclude_0_to_4", "evens_only")
+    .monitor("num");
+
+  g.execute("short_circuit_predicates_t");
+
+  // The more expensive predicate is evaluated only for the even numbers.
+  CHECK(g.execution_counts("evens_only") == 10ull);
+  CHECK(g.execution_counts("exclude_0_to_4") == 5ull);
+  CHECK(g.execution_counts("collect_evens") == 3ull);
+}
+
+TEST_CASE("Predicate pushdown", "[filtering]")
+{
+  framework_graph g{[src = source{10u}]() mutable { return src.next(); }};
+  g.with(evens_only, concurrency::unlimited).evaluate("num");
+  g.with(square, concurrency::unlimited).transform("num").to("squared_num");
+  g.with(add_one, concurrency::unlimited).transform("squared_num").to("squared_num_plus_one");
+
+  auto const expected_numbers = {1u, 5u, 17u, 37u, 65u};
+  g.make<collect_numbers>(expected_numbers)
+    .with("collect_evens", &collect_numbers::collect, concurrency::unlimited)
+    .when("evens_only")
+    .monitor("squared_num_plus_one");
+
+  g.execute("predicate_pushdown_t");
+
+  // Both transforms feed only the guarded monitor, so neither runs for odd numbers.
+  CHECK(g.execution_counts("square") == 5ull);
+  CHECK(g.execution_counts("add_one") == 5ull);
+  CHECK(g.execution_counts("collect_evens") == 5ull);
+
+  std::ifstream file{"predicate_pushdown_t-functions.gv"};
+  std::string const graph{std::istreambuf_iterator<char>{file}, {}};
+  for (std::string const transform : {"square", "add_one"}) {
+    auto const edge = "\"evens_only\" -> \"" + transform +
+                      "\" [color=red, fontcolor=red, fontsize=12, label=\" (pushdown)\", "
+                      "style=dashed]";
+    CHECK_THAT(graph, Catch::Matchers::ContainsSubstring(edge));
+  }
+}
+
+TEST_CASE("No predicate pushdown for unguarded consumers", "[filtering]")
+{
+  framework_graph g{[src = source{10u}]() mutable { return src.next(); }};
+  g.with(evens_only, concurrency::unlimited).evaluate("num");
+  g.with(square, concurrency::unlimited).transform("num").to("squared_num");
+  g.with(ignore_number, concurrency::unlimited).monitor("squared_num");
+  g.make<sum_numbers>(0u + 4u + 16u + 36u + 64u)
+    .with(&sum_numbers::add, concurrency::unlimited)
+    .when("evens_only")
+    .monitor("squared_num");
+
+  g.execute();
+
+  CHECK(g.execution_counts("square") == 10ull);
+  CHECK(g.execution_counts("add") == 5ull);
+}
@@ -1,36 +1,172 @@
 #include "meld/core/detail/filter_impl.hpp"
+#include "meld/model/product_store.hpp"
 
 #include "catch2/catch_all.hpp"
 
+#include <vector>
+
 using namespace meld;
 
-TEST_CASE("Filter values", "[filtering]")
-{
-  CHECK(is_complete(true_value));
-  CHECK(is_complete(false_value));
-  CHECK(not is_complete(0u));
+namespace {
+  // The next message ID that maps to the same slot as the specified ID
+  std::size_t colliding_id(std::size_t const id)
+  {
+    auto result = id + 1;
+    while (detail::slot_index(result) != detail::slot_index(id)) {
+      ++result;
+    }
+    return result;
+  }
 }
 
 TEST_CASE("Filter decision", "[filtering]")
 {
-  decision_map decisions{2};
-  decisions.update({nullptr, 1, false});
-  {
-    auto const value = decisions.value(1);
-    CHECK(is_complete(value));
-    CHECK(to_boolean(value) == false);
-    decisions.erase(1);
-  }
-  decisions.update({nullptr, 3, true});
-  {
-    auto const value = decisions.value(3);
-    CHECK(not is_complete(value));
+  auto store = product_store::base();
+  filter_records records{2, filter_records::for_output};
+
+  // Rejected by the first predicate; the decision is made once all inputs are in.
+  CHECK_FALSE(records.vote({nullptr, 1, false}));
+  CHECK_FALSE(records.add_data({store, nullptr, 1}));
+  auto rejected = records.vote({nullptr, 1, true});
+  REQUIRE(rejected);
+  CHECK_FALSE(rejected->accepted);
+  CHECK(rejected->store_hash() == store->id()->hash());
+
+  // Accepted, with the data arriving last
+  CHECK_FALSE(records.vote({nullptr, 3, true}));
+  CHECK_FALSE(records.vote({nullptr, 3, true}));
+  auto accepted = records.add_data({store, nullptr, 3});
+  REQUIRE(accepted);
+  CHECK(accepted->accepted);
+  REQUIRE(accepted->stores.size() == 1ull);
+  CHECK(accepted->stores[0] == store);
+}
+
+TEST_CASE("Filter data from several stores", "[filtering]")
+{
+  std::vector<specified_label> const labels{specified_label::create("a"),
+                                            specified_label::create("b")};
+  filter_records records{1, labels};
+
+  auto store_a = product_store::base();
+  store_a->add_product("a", 1);
+  auto store_b = store_a->make_continuation("provides_b");
+  store_b->add_product("b", 2);
+
+  // The node receives one message per input argument.
+  CHECK_FALSE(records.add_data({store_b, nullptr, 7}));
+  CHECK_FALSE(records.vote({nullptr, 7, true}));
+  auto decision = records.add_data({store_a, nullptr, 7});
+  REQUIRE(decision);
+  CHECK(decision->accepted);
+  REQUIRE(decision->stores.size() == 2ull);
+  CHECK(decision->stores[0] == store_a);
+  CHECK(decision->stores[1] == store_b);
+}
+
+TEST_CASE("Filter releases inputs of rejected messages", "[filtering]")
+{
+  std::vector<std::size_t> released;
+  auto release = [&released](std::size_t const i, product_store_const_ptr const&) {
+    released.push_back(i);
+  };
+  filter_records records{2, filter_records::for_output, release};
+  auto store = product_store::base();
+
+  // Data that arrived before the rejection is released by the rejecting vote...
+  CHECK_FALSE(records.add_data({store, nullptr, 1}));
+  CHECK(empty(released));
+  CHECK_FALSE(records.vote({nullptr, 1, false}));
+  CHECK(released.size() == 1ull);
+
+  // ...and data that arrives after the rejection is released upon arrival.
+  CHECK_FALSE(records.vote({nullptr, 2, false}));
+  CHECK(released.size() == 1ull);
+  CHECK_FALSE(records.add_data({store, nullptr, 2}));
+  CHECK(released.size() == 2ull);
+
+  // The decision is still made once all inputs are in.
+  auto decision = records.vote({nullptr, 2, true});
+  REQUIRE(decision);
+  CHECK_FALSE(decision->accepted);
+  CHECK(released.size() == 2ull);
+}
+
+TEST_CASE("Filter frees records of rejected messages once all inputs are in", "[filtering]")
+{
+  std::vector<std::size_t> released;
+  auto release = [&released](std::size_t const i, product_store_const_ptr const&) {
+    released.push_back(i);
+  };
+  std::vector<specified_label> const labels{specified_label::create("a"),
+                                            specified_label::create("b")};
+  filter_records records{2, labels, release};
+
+  auto store_a = product_store::base();
+  store_a->add_product("a", 1);
+  auto store_b = store_a->make_continuation("provides_b");
+  store_b->add_product("b", 2);
+
+  // The input for "b" has not arrived when the votes are in.
+  CHECK_FALSE(records.add_data({store_a, nullptr, 3}));
+  CHECK_FALSE(records.vote({nullptr, 3, false}));
+  CHECK_FALSE(records.vote({nullptr, 3, true}));
+  CHECK(released == std::vector<std::size_t>{0});
+
+  // The record is kept until the input for "b" arrives; a colliding message ID therefore
+  // overflows.
+  auto const next = colliding_id(3);
+  CHECK_FALSE(records.vote({nullptr, next, true}));
+  CHECK(records.overflow_size() == 1ull);
+
+  // The input for "b" arrives as a placeholder, because the node providing it did not run
+  // for the message.  The rejection is then decided, and the record is freed.  The
+  // decision names the store that did arrive, although its products were released.
+  auto rejected = records.add_data({nullptr, nullptr, 3});
+  REQUIRE(rejected);
+  CHECK_FALSE(rejected->accepted);
+  REQUIRE(rejected->stores.size() == 2ull);
+  CHECK(rejected->stores[0] == store_a);
+  CHECK(rejected->stores[1] == nullptr);
+  CHECK(rejected->store_hash() == store_a->id()->hash());
+  CHECK(released == std::vector<std::size_t>{0});
+
+  // Late inputs that provide products are released upon arrival.
+  CHECK_FALSE(records.vote({nullptr, 5, false}));
+  CHECK_FALSE(records.vote({nullptr, 5, true}));
+  CHECK_FALSE(records.add_data({store_b, nullptr, 5}));
+  CHECK(released == std::vector<std::size_t>{0, 1});
+  CHECK(records.add_data({store_b, nullptr, 5}));
+  CHECK(released == std::vector<std::size_t>{0, 1});
+
+  // Completing the overflowing record leaves all slots free.
+  CHECK_FALSE(records.vote({nullptr, next, true}));
+  CHECK_FALSE(records.add_data({store_a, nullptr, next}));
+  auto accepted = records.add_data({store_b, nullptr, next});
+  REQUIRE(accepted);
+  CHECK(accepted->accepted);
+  CHECK(records.overflow_size() == 0ull);
+  CHECK_FALSE(records.vote({nullptr, 3, true}));
+  CHECK(records.overflow_size() == 0ull);
+}
+
+TEST_CASE("Filter records with colliding message IDs", "[filtering]")
+{
+  auto store = product_store::base();
+  filter_records records{1, filter_records::for_output};
+
+  std::size_t const first{5};
+  auto const second = colliding_id(first);
+  auto const third = colliding_id(second);
+  for (auto const id : {first, second, third}) {
+    CHECK_FALSE(records.vote({nullptr, id, true}));
   }
-  decisions.update({nullptr, 3, true});
-  {
-    auto const value = decisions.value(3);
-    CHECK(is_complete(value));
-    CHECK(to_boolean(value) == true);
-    decisions.erase(3);
+  CHECK(records.overflow_size() == 2ull);
+
+  for (auto const id : {second, first, third}) {
+    auto decision = records.add_data({store, nullptr, id});
+    REQUIRE(decision);
+    CHECK(decision->accepted);
   }
+  CHECK(records.overflow_size() == 0ull);
 }
@@ -5,6 +5,10 @@
 #include "meld/utilities/hashing.hpp"
 
 #include "catch2/catch_all.hpp"
+#include "oneapi/tbb/parallel_for.h"
+
+#include <atomic>
+#include <thread>
 
 using namespace meld;
 
@@ -96,3 +100,42 @@ TEST_CASE("Counter multiple layers deep", "[data model]")
   CHECK(results.count_for(run_hash_value) == nruns);
   check_all_processed();
 }
+
+TEST_CASE("Hierarchy counts from several threads", "[data model]")
+{
+  level_hierarchy h;
+  auto const run = level_id::base().make_child(0, "run");
+  h.increment_count(level_id::base_ptr());
+  h.increment_count(run);
+  tbb::parallel_for(0u, 1000u, [&h, &run](unsigned int i) {
+    h.increment_count(run->make_child(i, "event"));
+  });
+  CHECK(h.count_for("run") == 1);
+  CHECK(h.count_for("event") == 1000);
+  CHECK(h.count_for("subrun") == 0);
+}
+
+TEST_CASE("Hierarchy counts read while counting", "[data model]")
+{
+  level_hierarchy h;
+  auto const run = level_id::base().make_child(0, "run");
+  h.increment_count(level_id::base_ptr());
+  h.increment_count(run);
+  std::atomic<bool> counting{true};
+  std::size_t last_count{};
+  bool monotonic{true};
+  std::thread reader{[&] {
+    while (counting) {
+      auto const count = h.count_for("event");
+      monotonic = monotonic and count >= last_count;
+      last_count = count;
+    }
+  }};
+  tbb::parallel_for(0u, 1000u, [&h, &run](unsigned int i) {
+    h.increment_count(run->make_child(i, "event"));
+  });
+  counting = false;
+  reader.join();
+  CHECK(monotonic);
+  CHECK(h.count_for("event") == 1000);
+}
@@ -32,3 +32,62 @@ TEST_CASE("Verify independent hashes", "[data model]")
   CHECK(event_760->hash() != event_4999->hash());
   CHECK(event_760->level_hash() == event_4999->level_hash());
 }
+
+TEST_CASE("Level ID comparisons", "[data model]")
+{
+  auto base = level_id::base_ptr();
+  auto run_1 = base->make_child(1, "run");
+  auto run_2 = base->make_child(2, "run");
+  auto event_1_3 = run_1->make_child(3, "event");
+  auto event_2_1 = run_2->make_child(1, "event");
+
+  CHECK(*base < *run_1);
+  CHECK(*run_1 < *run_2);
+  CHECK(*run_1 < *event_1_3);
+  CHECK(*event_1_3 < *run_2);
+  CHECK(*event_1_3 < *event_2_1);
+  CHECK_FALSE(*event_2_1 < *event_1_3);
+
+  CHECK(*event_1_3 == *id_for({1, 3}));
+  CHECK(*event_1_3 == *run_1->make_child(3, "event"));
+  CHECK_FALSE(*event_1_3 == *event_2_1);
+
+  // Level names are shared by all IDs of the same level type.
+  CHECK(&event_1_3->level_name() == &event_2_1->level_name());
+  CHECK(event_1_3->level_name() == "event");
+  CHECK(event_1_3->depth() == 2ull);
+  CHECK(event_1_3->number() == 3ull);
+  CHECK(event_1_3->parent("run") == run_1);
+  CHECK(event_1_3->parent("subrun") == nullptr);
+  CHECK(event_1_3->to_string() == "[run:1, event:3]");
+}
+
+TEST_CASE("Ancestor lookup by level key", "[data model]")
+{
+  level_key const job{"job"};
+  level_key const run{"run"};
+  level_key const subrun{"subrun"};
+  level_key const event{"event"};
+  CHECK(run == level_key{"run"});
+  CHECK(run.name() == "run");
+  CHECK_FALSE(level_key{}.valid());
+
+  auto base = level_id::base_ptr();
+  auto run_1 = base->make_child(1, "run");
+  auto subrun_2 = run_1->make_child(2, "subrun");
+  auto event_3 = subrun_2->make_child(3, "event");
+  CHECK(event_3->level_name_key() == event);
+
+  CHECK(event_3->parent(subrun) == subrun_2);
+  CHECK(event_3->parent(run) == run_1);
+  CHECK(event_3->parent(job) == base);
+  CHECK(event_3->parent(event) == nullptr);
+  CHECK(base->parent(job) == nullptr);
+
+  // The nearest ancestor is chosen when a level name recurs in the hierarchy.
+  auto nested_run = event_3->make_child(4, "run");
+  auto nested_event = nested_run->make_child(5, "event");
+  CHECK(nested_event->parent(run) == nested_run);
+  CHECK(nested_event->parent(event) == event_3);
+  CHECK(nested_event->parent(subrun) == subrun_2);
+}
@@ -1,11 +1,34 @@
+// =======================================================================================
+// This test processes many events while limiting the number of events in flight.  It
+// verifies that the source never runs ahead of the completed events by more than the
+// limit, that the peak RSS does not grow once the first events have been processed, and
+// that the source's cache of product stores stays bounded.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
 #include "meld/core/framework_graph.hpp"
 #include "meld/model/product_store.hpp"
 #include "test/products_for_output.hpp"
 
+#include "spdlog/spdlog.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
 using namespace meld;
 
 namespace {
   unsigned pass_on(unsigned number) { return number; }
+
+  long max_rss_kb()
+  {
+    rusage used;
+    getrusage(RUSAGE_SELF, &used);
+    return used.ru_maxrss;
+  }
 }
 
 int main()
@@ -13,22 +36,62 @@ int main()
   constexpr auto max_events{100'000u};
   // constexpr auto max_events{1'000'000u};
   // spdlog::flush_on(spdlog::level::trace);
+  constexpr std::size_t max_events_in_flight{16};
 
-  framework_graph g{[i = 0u]() mutable -> product_store_ptr {
+  std::atomic<unsigned> completed_events{};
+  unsigned max_read_ahead{};
+  long early_rss_kb{};
+  std::size_t max_cached_stores{};
+
+  framework_graph g{[&, i = 0u](cached_product_stores& cached_stores) mutable -> product_store_ptr {
     if (i == max_events + 1) { // + 1 is for initial product store
       return nullptr;
     }
     if (i == 0u) {
       ++i;
-      return product_store::base();
+      return cached_stores.get_store();
+    }
+    if (i == max_events / 10) {
+      early_rss_kb = max_rss_kb();
+    }
+    if (auto const completed = completed_events.load(); i > completed) {
+      max_read_ahead = std::max(max_read_ahead, i - completed);
     }
 
-    auto store = product_store::base()->make_child(i, "event", "Source");
+    auto store = cached_stores.get_store(level_id::base().make_child(i, "event"));
+    max_cached_stores = std::max(max_cached_stores, cached_stores.size());
     store->add_product("number", i);
     ++i;
     return store;
   }};
 
   g.with(pass_on, concurrency::unlimited).transform("number").to("different");
+  g.with("count_event", [&completed_events](unsigned) { ++completed_events; })
+    .monitor("different");
+  g.limit_events_in_flight(max_events_in_flight);
   g.execute();
+
+  auto const final_rss_kb = max_rss_kb();
+  spdlog::info("Events read ahead of completed events: {}", max_read_ahead);
+  spdlog::info("Max. RSS after {} events: {} kB; at end: {} kB",
+               max_events / 10,
+               early_rss_kb,
+               final_rss_kb);
+
+  // The source reads one store ahead, and one message may wait at the window.  The
+  // monitor counts an event before the event's token is returned.
+  if (max_read_ahead > max_events_in_flight + 2) {
+    spdlog::error("The source read too far ahead.");
+    return 1;
+  }
+  constexpr long allowed_growth_kb{10'000};
+  if (final_rss_kb - early_rss_kb > allowed_growth_kb) {
+    spdlog::error("The peak RSS grew by more than {} kB.", allowed_growth_kb);
+    return 2;
+  }
+  // Only the base store and the current event store should be cached.
+  if (max_cached_stores > 2ull) {
+    spdlog::error("The source cached {} product stores.", max_cached_stores);
+    return 3;
+  }
 }
@@ -0,0 +1,88 @@
+// =======================================================================================
+// This test verifies that products with size hooks are accounted for as live product
+// bytes, and that an event window with a memory governor holds new events while the
+// memory usage is above the governor's high watermark.
+// =======================================================================================
+
+#include "meld/core/end_of_message.hpp"
+#include "meld/core/event_window.hpp"
+#include "meld/core/memory_governor.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/flow_graph.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  struct blob {
+    std::vector<char> bytes;
+  };
+}
+
+template <>
+struct meld::product_size<blob> {
+  std::size_t operator()(blob const& b) const { return b.bytes.size(); }
+};
+
+TEST_CASE("Live product bytes", "[memory]")
+{
+  auto const before = live_product_bytes();
+  {
+    auto store = product_store::base();
+    store->add_product("blob", blob{std::vector<char>(600)});
+    store->add_product("number", 3); // No size hook
+    CHECK(product_sizes_reported());
+    CHECK(live_product_bytes() == before + 600ull);
+  }
+  CHECK(live_product_bytes() == before);
+}
+
+TEST_CASE("Hold events above the high watermark", "[memory]")
+{
+  tbb::flow::graph g;
+  event_window window{g, 8, std::make_unique<memory_governor>(1000, 0.5)};
+
+  std::vector<std::size_t> processed;
+  tbb::flow::function_node<message> sink{g, tbb::flow::serial, [&processed](message const& msg) {
+                                           processed.push_back(msg.id);
+                                         }};
+  make_edge(window.output(), sink);
+
+  std::vector<end_of_message_ptr> eoms;
+  auto send_event = [&](std::size_t const id) {
+    auto store = product_store::base()->make_child(id, "event");
+    store->enable_early_release();
+    auto const& eom = eoms.emplace_back(end_of_message::make_base(nullptr, store->id()));
+    window.input().try_put({store, eom, id});
+    g.wait_for_all();
+  };
+
+  // Usage above the high watermark
+  auto store = product_store::base();
+  store->add_product("blob", blob{std::vector<char>(600)});
+  REQUIRE(live_product_bytes() > 500ull);
+
+  // The first event is processed because no other event is; the others are held.
+  send_event(1);
+  send_event(2);
+  send_event(3);
+  CHECK(processed == std::vector<std::size_t>{1});
+  CHECK(window.held_events() == 2ull);
+
+  // While the usage stays high, one held event is processed after another.
+  eoms[0].reset();
+  g.wait_for_all();
+  CHECK(processed == std::vector<std::size_t>{1, 2});
+
+  // Once the usage drops, all held events are processed.
+  store.reset();
+  eoms[1].reset();
+  g.wait_for_all();
+  CHECK(processed == std::vector<std::size_t>{1, 2, 3});
+  CHECK(window.held_events() == 2ull);
+}
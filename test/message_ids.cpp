@@ -0,0 +1,138 @@
+// =======================================================================================
+// This test checks that message IDs are unique framework-wide, including when messages are
+// created by nested splitters and matched by downstream join nodes at high concurrency:
+//
+//     Multiplexer
+//          |
+//      splitter (event -> lower1)
+//          |
+//      splitter (lower1 -> lower2)
+//          |
+//   square + twice
+//          |
+//       combine (joins the outputs of square and twice)
+//          |
+//         add(*)
+//          |
+//    check_partial
+//
+// where the asterisk (*) indicates a reduction step.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/core/message.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/concurrent_vector.h"
+#include "oneapi/tbb/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  constexpr auto n_events = 8u;
+  constexpr auto n_outer = 20u;
+  constexpr auto n_inner = 5u;
+
+  class iota {
+  public:
+    explicit iota(unsigned int max_number) : max_{max_number} {}
+    unsigned int initial_value() const { return 0; }
+    bool predicate(unsigned int i) const { return i != max_; }
+    auto unfold(unsigned int i) const { return std::make_pair(i + 1, i); };
+
+  private:
+    unsigned int max_;
+  };
+
+  class repeat {
+  public:
+    explicit repeat(unsigned int value) : value_{value} {}
+    unsigned int initial_value() const { return 0; }
+    bool predicate(unsigned int i) const { return i != n_inner; }
+    auto unfold(unsigned int i) const { return std::make_pair(i + 1, value_); };
+
+  private:
+    unsigned int value_;
+  };
+
+  unsigned int square(unsigned int i) { return i * i; }
+  unsigned int twice(unsigned int i) { return 2 * i; }
+  unsigned int combine(unsigned int a, unsigned int b) { return a + b; }
+  void add(std::atomic<unsigned int>& counter, unsigned number) { counter += number; }
+}
+
+TEST_CASE("Message IDs are unique across threads", "[message]")
+{
+  constexpr std::size_t n_ids{100'000};
+  tbb::concurrent_vector<std::size_t> ids;
+  tbb::parallel_for(
+    std::size_t{}, n_ids, [&ids](std::size_t) { ids.push_back(next_message_id()); });
+
+  std::vector<std::size_t> sorted_ids(ids.begin(), ids.end());
+  std::ranges::sort(sorted_ids);
+  CHECK(std::ranges::adjacent_find(sorted_ids) == sorted_ids.end());
+  CHECK(std::ranges::find(sorted_ids, 0ull) == sorted_ids.end());
+}
+
+TEST_CASE("Joining products from nested splitters", "[graph]")
+{
+  std::vector<level_id_ptr> levels;
+  levels.reserve(n_events + 1u);
+  levels.push_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != n_events; ++i) {
+    levels.push_back(level_id::base().make_child(i, "event"));
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+                      if (it == e) {
+                        return nullptr;
+                      }
+                      auto const& id = *it++;
+
+                      auto store = cached_stores.get_store(id);
+                      if (store->id()->level_name() == "event") {
+                        store->add_product("max_number", unsigned{n_outer});
+                      }
+                      return store;
+                    },
+                    16};
+
+  g.with<iota>(&iota::predicate, &iota::unfold, concurrency::unlimited)
+    .split("max_number")
+    .into("outer")
+    .within_family("lower1");
+  g.with<repeat>(&repeat::predicate, &repeat::unfold, concurrency::unlimited)
+    .split("outer")
+    .into("inner")
+    .within_family("lower2");
+  g.with(square, concurrency::unlimited).transform("inner").to("squared");
+  g.with(twice, concurrency::unlimited).transform("inner").to("doubled");
+  g.with(combine, concurrency::unlimited).transform("squared", "doubled").to("combined");
+  g.with(add, concurrency::unlimited).reduce("combined").for_each("lower1").to("partial");
+  g.with(
+     "check_partial",
+     [](handle<unsigned int> const partial) {
+       // Each outer value v is repeated n_inner times, contributing v*v + 2*v each time.
+       auto const v = static_cast<unsigned int>(partial.level_id().number());
+       CHECK(*partial == n_inner * (v * v + 2 * v));
+     },
+     concurrency::unlimited)
+    .monitor("partial");
+
+  g.execute();
+
+  CHECK(g.execution_counts("iota") == n_events);
+  CHECK(g.execution_counts("repeat") == n_events * n_outer);
+  CHECK(g.execution_counts("combine") == n_events * n_outer * n_inner);
+  CHECK(g.execution_counts("add") == n_events * n_outer * n_inner);
+  CHECK(g.execution_counts("check_partial") == n_events * n_outer);
+}
@@ -0,0 +1,99 @@
+// =======================================================================================
+// This test verifies that the message_join used by multi-input nodes combines exactly
+// the messages that carry the same message ID, including when several pending IDs map
+// to the same slot of the join's table.
+// =======================================================================================
+
+#include "meld/core/message.hpp"
+
+#include "catch2/catch_all.hpp"
+#include "oneapi/tbb/flow_graph.h"
+#include "oneapi/tbb/parallel_for.h"
+
+#include <atomic>
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  constexpr std::size_t slot_count = detail::join_messages_t<3>::slot_count;
+
+  // The next message ID that maps to the same slot as the specified ID
+  std::size_t colliding_id(std::size_t const id)
+  {
+    auto result = id + 1;
+    while (detail::slot_index(result) != detail::slot_index(id)) {
+      ++result;
+    }
+    return result;
+  }
+
+  struct joined_messages {
+    std::atomic<std::size_t> tuples{};
+    std::atomic<std::size_t> mismatches{};
+
+    void operator()(messages_t<3> const& msgs)
+    {
+      auto const& [a, b, c] = msgs;
+      if (a.id != b.id or b.id != c.id) {
+        ++mismatches;
+      }
+      ++tuples;
+    }
+  };
+}
+
+TEST_CASE("Join messages with colliding IDs", "[graph]")
+{
+  tbb::flow::graph g;
+  auto join = make_join_or_none(g, std::make_index_sequence<3>{});
+  joined_messages joined;
+  tbb::flow::function_node<messages_t<3>> sink{
+    g, tbb::flow::serial, [&joined](messages_t<3> const& msgs) { joined(msgs); }};
+  make_edge(join, sink);
+  auto ports = input_ports<3>(join);
+
+  // The IDs all map to the same slot.
+  auto const second = colliding_id(1);
+  std::vector<std::size_t> const ids{1, second, colliding_id(second)};
+  for (auto const id : ids) {
+    ports[0]->try_put({nullptr, nullptr, id});
+  }
+  g.wait_for_all();
+  CHECK(join.overflow_size() == 2ull);
+
+  // Complete the IDs in an order different from the one in which the slot was claimed.
+  for (auto const id : {ids[2], ids[0], ids[1]}) {
+    ports[2]->try_put({nullptr, nullptr, id});
+    ports[1]->try_put({nullptr, nullptr, id});
+  }
+  g.wait_for_all();
+
+  CHECK(joined.tuples == 3ull);
+  CHECK(joined.mismatches == 0ull);
+  CHECK(join.overflow_size() == 0ull);
+}
+
+TEST_CASE("Join messages concurrently", "[graph]")
+{
+  constexpr std::size_t n_ids{20 * slot_count};
+
+  tbb::flow::graph g;
+  auto join = make_join_or_none(g, std::make_index_sequence<3>{});
+  joined_messages joined;
+  tbb::flow::function_node<messages_t<3>> sink{
+    g, tbb::flow::unlimited, [&joined](messages_t<3> const& msgs) { joined(msgs); }};
+  make_edge(join, sink);
+  auto ports = input_ports<3>(join);
+
+  tbb::parallel_for(std::size_t{}, 3 * n_ids, [&ports](std::size_t const i) {
+    ports[i % 3]->try_put({nullptr, nullptr, i / 3});
+  });
+  g.wait_for_all();
+
+  CHECK(joined.tuples == n_ids);
+  CHECK(joined.mismatches == 0ull);
+  CHECK(join.overflow_size() == 0ull);
+}
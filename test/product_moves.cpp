@@ -0,0 +1,108 @@
+// =======================================================================================
+// This test verifies that products are moved--or constructed in place--into product
+// stores, both when inserted directly and when returned from a transform.  The
+// copy_counted type records how many times it has been copied or moved.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+using namespace meld;
+
+namespace {
+  std::atomic<unsigned> copies{};
+  std::atomic<unsigned> moves{};
+
+  void reset_counts()
+  {
+    copies = 0;
+    moves = 0;
+  }
+
+  struct copy_counted {
+    explicit copy_counted(int n = 0) : value{n} {}
+    copy_counted(int a, int b) : value{a + b} {}
+    copy_counted(copy_counted const& other) : value{other.value} { ++copies; }
+    copy_counted(copy_counted&& other) noexcept : value{other.value} { ++moves; }
+    copy_counted& operator=(copy_counted const&) = delete;
+    copy_counted& operator=(copy_counted&&) = delete;
+    int value;
+  };
+
+  std::tuple<copy_counted, copy_counted> make_pair_of(std::size_t const number)
+  {
+    return {copy_counted{static_cast<int>(number)}, copy_counted{-static_cast<int>(number)}};
+  }
+
+  void check_sum(copy_counted const& a, copy_counted const& b) { CHECK(a.value + b.value == 0); }
+}
+
+TEST_CASE("Move products into store", "[data model]")
+{
+  reset_counts();
+  auto store = product_store::base();
+  copy_counted c{3};
+  store->add_product("moved", std::move(c));
+  CHECK(copies == 0u);
+  CHECK(moves == 1u);
+  CHECK(store->get_product<copy_counted>("moved").value == 3);
+
+  store->add_product("copied", c);
+  CHECK(copies == 1u);
+}
+
+TEST_CASE("Emplace products into store", "[data model]")
+{
+  reset_counts();
+  auto store = product_store::base();
+  store->emplace_product<copy_counted>("emplaced", 1, 2);
+  store->emplace_product<std::vector<int>>(product_key{"numbers"}, 3u, 7);
+  CHECK(copies == 0u);
+  CHECK(moves == 0u);
+  CHECK(store->get_product<copy_counted>("emplaced").value == 3);
+  CHECK(store->get_product<std::vector<int>>("numbers") == std::vector{7, 7, 7});
+}
+
+TEST_CASE("Transform results are not copied", "[graph]")
+{
+  constexpr unsigned max_events{10u};
+  std::vector<level_id_ptr> levels;
+  levels.reserve(max_events + 1u);
+  levels.push_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != max_events; ++i) {
+    levels.push_back(levels.front()->make_child(i, "event"));
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+    if (it == e) {
+      return nullptr;
+    }
+    auto const& id = *it++;
+    auto store = cached_stores.get_store(id);
+    if (id->level_name() == "event") {
+      store->add_product("number", id->number());
+    }
+    return store;
+  }};
+
+  g.with("make_pair_of", make_pair_of, concurrency::unlimited)
+    .transform("number")
+    .to("a", "b");
+  g.with("check_sum", check_sum, concurrency::unlimited).monitor("a", "b");
+
+  reset_counts();
+  g.execute("product_moves_t");
+  CHECK(copies == 0u);
+  CHECK(g.execution_counts("check_sum") == max_events);
+}
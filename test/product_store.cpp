@@ -71,4 +71,131 @@ TEST_CASE("Product store derivation", "[data model]")
   CHECK(leaf == most_derived(order_a));
   CHECK(leaf == most_derived(order_b));
   CHECK(leaf == most_derived(order_c));
+
+  CHECK(leaf->parent(level_key{"branch"}) == branch);
+  CHECK(leaf->parent(level_key{"trunk"}) == trunk);
+  CHECK(leaf->parent(level_key{"bole"}) == nullptr);
+}
+
+TEST_CASE("Product store access with interned keys", "[data model]")
+{
+  product_key const number_key{"number"};
+  CHECK(number_key == product_key{std::string{"number"}});
+  CHECK(number_key != product_key{"numbers"});
+  CHECK(number_key.name() == "number");
+
+  auto store = product_store::base();
+  store->add_product(number_key, 4);
+  CHECK(store->contains_product(number_key));
+  CHECK(store->contains_product("number"));
+  CHECK_FALSE(store->contains_product(product_key{"numbers"}));
+  CHECK(store->get_product<int>(number_key) == 4);
+  CHECK(store->get_product<int>("number") == 4);
+
+  auto child = store->make_child(1, "child");
+  CHECK(child->store_for_product(number_key) == store);
+}
+
+TEST_CASE("Product store arenas", "[data model]")
+{
+  auto root = product_store::base();
+  CHECK_FALSE(root->arena());
+
+  auto event = root->make_child(1, "event");
+  REQUIRE(event->arena());
+  event->add_product("number", 3);
+
+  // Continuations and flush stores belong to the same level instance and therefore
+  // share its arena; each new level instance receives its own arena.
+  CHECK(event->make_continuation("transform")->arena() == event->arena());
+  CHECK(event->make_flush()->arena() == event->arena());
+  CHECK(root->make_child(2, "event")->arena() != event->arena());
+  CHECK(event->make_child(1, "subevent")->arena() != event->arena());
+
+  // The arena outlives the stores allocated from it, even if the products are retained.
+  std::weak_ptr<store_arena> arena = event->arena();
+  auto continuation = event->make_continuation("transform");
+  event.reset();
+  CHECK_FALSE(arena.expired());
+  continuation.reset();
+  CHECK(arena.expired());
+}
+
+TEST_CASE("Product store early release", "[data model]")
+{
+  product_key const number_key{"number"};
+  auto root = product_store::base();
+  root->add_product(number_key, 1);
+
+  auto event = root->make_child(1, "event");
+  event->add_product(number_key, 2);
+  event->enable_early_release();
+  auto continuation = event->make_continuation("transform");
+  CHECK(continuation->early_release_enabled());
+
+  // Stores without early release keep their products
+  root->release_after_use(number_key, 1);
+  CHECK(root->get_product<int>(number_key) == 1);
+
+  // The product is released by its last consumer; its key remains in the store
+  event->release_after_use(number_key, 2);
+  CHECK(event->get_product<int>(number_key) == 2);
+  event->release_after_use(number_key, 2);
+  CHECK(event->contains_product(number_key));
+  CHECK_THROWS_WITH(event->get_product<int>(number_key),
+                    Catch::Matchers::ContainsSubstring("has already been released"));
+}
+
+TEST_CASE("Product lookup precedence", "[data model]")
+{
+  auto root = product_store::base();
+  root->add_product("calibration", 1.5);
+  auto event = root->make_child(1, "event");
+  event->add_product("digits", 3);
+  CHECK(event->store_for_product("digits") == event);
+  CHECK(event->store_for_product("calibration") == root);
+  CHECK_FALSE(event->store_for_product("missing"));
+
+  // A store's own products are found first, followed by those of its ancestors.
+  auto continuation = event->make_continuation("transform");
+  continuation->add_product("calibration", 2.5);
+  continuation->add_product("hits", 2);
+  CHECK(continuation->store_for_product("calibration") == continuation);
+  CHECK(continuation->store_for_product("hits") == continuation);
+
+  // Products of continuations do not shadow those found by walking up the hierarchy.
+  CHECK(event->store_for_product("calibration") == root);
+  CHECK_FALSE(event->store_for_product("hits"));
+  auto subevent = event->make_child(0, "subevent");
+  CHECK(subevent->store_for_product("calibration") == root);
+  CHECK(subevent->store_for_product("digits") == event);
+
+  // Products added after the store's creation are found as well.
+  event->add_product("tracks", 4);
+  CHECK(subevent->store_for_product("tracks") == event);
+}
+
+TEST_CASE("Store shapes", "[data model]")
+{
+  auto root = product_store::base();
+  root->add_product("calibration", 1.5);
+  auto first = root->make_child(0, "event");
+  first->add_product("digits", 3);
+  auto second = root->make_child(1, "event");
+  second->add_product("digits", 4);
+  CHECK(first->shape_hash() == second->shape_hash());
+
+  // Stores differ in shape if their products or levels differ...
+  auto third = root->make_child(2, "event");
+  third->add_product("hits", 3);
+  CHECK(third->shape_hash() != first->shape_hash());
+  auto run = root->make_child(0, "run");
+  run->add_product("digits", 3);
+  CHECK(run->shape_hash() != first->shape_hash());
+
+  // ...or if the products of their ancestors differ.
+  auto other_root = product_store::base();
+  auto fourth = other_root->make_child(3, "event");
+  fourth->add_product("digits", 3);
+  CHECK(fourth->shape_hash() != first->shape_hash());
 }
@@ -25,6 +25,7 @@
 
 #include "meld/core/cached_product_stores.hpp"
 #include "meld/core/framework_graph.hpp"
+#include "meld/core/reduction/combine.hpp"
 #include "meld/model/level_id.hpp"
 #include "meld/model/product_store.hpp"
 
@@ -32,6 +33,8 @@
 #include "spdlog/spdlog.h"
 
 #include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -98,3 +101,236 @@ TEST_CASE("Different levels of reduction", "[graph]")
   CHECK(g.execution_counts("verify_two_layer_job_sum") == 1);
   CHECK(g.execution_counts("verify_job_sum") == 1);
 }
+
+TEST_CASE("Reduction with per-thread partial results", "[graph]")
+{
+  constexpr auto index_limit = 2u;
+  constexpr auto number_limit = 100u;
+  std::vector<level_id_ptr> levels;
+  levels.reserve(1 + index_limit * (number_limit + 1u));
+  auto job_id = levels.emplace_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != index_limit; ++i) {
+    auto run_id = levels.emplace_back(job_id->make_child(i, "run"));
+    for (unsigned j = 0u; j != number_limit; ++j) {
+      levels.push_back(run_id->make_child(j, "event"));
+    }
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+    if (it == e) {
+      return nullptr;
+    }
+    auto const& id = *it++;
+
+    auto store = cached_stores.get_store(id);
+    if (id->level_name() == "event") {
+      store->add_product<unsigned>("number", id->number());
+    }
+    return store;
+  }};
+
+  auto add_partial = [](unsigned& partial, unsigned number) { partial += number; };
+  auto combine = [](unsigned& total, unsigned const& partial) { total += partial; };
+  g.with("run_add", add_partial, concurrency::unlimited)
+    .reduce("number")
+    .for_each("run")
+    .combined_with(combine)
+    .to("run_sum");
+  g.with("job_add", add_partial, concurrency::unlimited)
+    .reduce("number")
+    .combined_with(combine)
+    .to("job_sum");
+
+  g.with(
+     "verify_run_sum", [](unsigned int actual) { CHECK(actual == 4950u); }, concurrency::unlimited)
+    .monitor("run_sum");
+  g.with(
+     "verify_job_sum", [](unsigned int actual) { CHECK(actual == 9900u); }, concurrency::unlimited)
+    .monitor("job_sum");
+
+  g.execute();
+
+  CHECK(g.execution_counts("run_add") == index_limit * number_limit);
+  CHECK(g.execution_counts("job_add") == index_limit * number_limit);
+  CHECK(g.execution_counts("verify_run_sum") == index_limit);
+  CHECK(g.execution_counts("verify_job_sum") == 1);
+}
+
+TEST_CASE("Combine partial results in a tree", "[graph]")
+{
+  std::vector<std::unique_ptr<std::vector<int>>> partials;
+  for (int i = 0; i != 7; ++i) {
+    partials.push_back(i == 3 ? nullptr : std::make_unique<std::vector<int>>(1, i));
+  }
+  auto concatenate = [](std::vector<int>& a, std::vector<int> const& b) {
+    a.insert(a.end(), b.begin(), b.end());
+  };
+  auto result = combine_in_tree(std::move(partials), concatenate);
+  REQUIRE(result);
+  CHECK(*result == std::vector<int>{0, 1, 2, 4, 5, 6});
+
+  CHECK_FALSE(combine_in_tree(std::vector<std::unique_ptr<int>>{}, std::plus<int>{}));
+}
+
+TEST_CASE("Rollup reduction", "[graph]")
+{
+  constexpr auto run_limit = 2u;
+  constexpr auto subrun_limit = 3u;
+  constexpr auto event_limit = 4u;
+  std::vector<level_id_ptr> levels;
+  auto job_id = levels.emplace_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != run_limit; ++i) {
+    auto run_id = levels.emplace_back(job_id->make_child(i, "run"));
+    for (unsigned j = 0u; j != subrun_limit; ++j) {
+      auto subrun_id = levels.emplace_back(run_id->make_child(j, "subrun"));
+      for (unsigned k = 0u; k != event_limit; ++k) {
+        levels.push_back(subrun_id->make_child(k, "event"));
+      }
+    }
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+    if (it == e) {
+      return nullptr;
+    }
+    auto const& id = *it++;
+
+    auto store = cached_stores.get_store(id);
+    if (id->level_name() == "event") {
+      store->add_product<unsigned>("number", 1u);
+    }
+    return store;
+  }};
+
+  std::atomic<unsigned> subrun_sums{};
+  std::atomic<unsigned> run_sums{};
+  std::atomic<unsigned> job_sums{};
+  g.with(
+     "add", [](unsigned& sum, unsigned number) { sum += number; }, concurrency::unlimited)
+    .reduce("number")
+    .for_each("subrun", "run", "job")
+    .combined_with([](unsigned& sum, unsigned const& partial) { sum += partial; })
+    .to("sum");
+  g.with(
+     "check_sum",
+     [&](unsigned int actual) {
+       switch (actual) {
+         case event_limit:
+           ++subrun_sums;
+           break;
+         case subrun_limit * event_limit:
+           ++run_sums;
+           break;
+         case run_limit * subrun_limit * event_limit:
+           ++job_sums;
+           break;
+         default:
+           FAIL_CHECK("Unexpected sum: " << actual);
+       }
+     },
+     concurrency::unlimited)
+    .monitor("sum");
+
+  g.execute();
+
+  // Each event is processed once, even though results are produced at three levels.
+  CHECK(g.execution_counts("add") == run_limit * subrun_limit * event_limit);
+  CHECK(subrun_sums == run_limit * subrun_limit);
+  CHECK(run_sums == run_limit);
+  CHECK(job_sums == 1u);
+}
+
+TEST_CASE("Rollup reduction without combine function", "[graph]")
+{
+  framework_graph g{product_store::base()};
+  CHECK_THROWS_WITH(g.with("add", add).reduce("number").for_each("run", "job").to("sum"),
+                    Catch::Matchers::ContainsSubstring("requires a combine function"));
+}
+
+TEST_CASE("Windows containing an instance", "[graph]")
+{
+  auto check = [](std::size_t instance,
+                  window_spec const& spec,
+                  std::size_t first,
+                  std::size_t last) {
+    auto const range = windows_containing(instance, spec);
+    CHECK(range.first == first);
+    CHECK(range.last == last);
+  };
+  window_spec const tumbling{"event", 3, 3};
+  check(0, tumbling, 0, 0);
+  check(2, tumbling, 0, 0);
+  check(3, tumbling, 1, 1);
+
+  window_spec const sliding{"event", 4, 2};
+  check(1, sliding, 0, 0);
+  check(2, sliding, 0, 1);
+  check(5, sliding, 1, 2);
+
+  window_spec const hopping{"event", 2, 3};
+  check(2, hopping, 1, 0); // Not in any window
+  check(4, hopping, 1, 1);
+}
+
+TEST_CASE("Window reductions", "[graph]")
+{
+  constexpr auto run_limit = 2u;
+  constexpr auto event_limit = 10u;
+  std::vector<level_id_ptr> levels;
+  auto job_id = levels.emplace_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != run_limit; ++i) {
+    auto run_id = levels.emplace_back(job_id->make_child(i, "run"));
+    for (unsigned j = 0u; j != event_limit; ++j) {
+      levels.push_back(run_id->make_child(j, "event"));
+    }
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+    if (it == e) {
+      return nullptr;
+    }
+    auto const& id = *it++;
+
+    auto store = cached_stores.get_store(id);
+    if (id->level_name() == "event") {
+      store->add_product<unsigned>("number", id->number());
+    }
+    return store;
+  }};
+
+  // Tumbling windows [0, 3), [3, 6), and [6, 9) are complete for each run.
+  g.with("tumbling_add", add, concurrency::unlimited)
+    .reduce("number")
+    .for_each_window("event", 3)
+    .to("tumbling_sum");
+  // Sliding windows [0, 4), [2, 6), [4, 8), and [6, 10) are complete for each run.
+  g.with(
+     "sliding_add", [](unsigned& sum, unsigned number) { sum += number; }, concurrency::unlimited)
+    .reduce("number")
+    .for_each_window("event", 4, 2)
+    .combined_with([](unsigned& sum, unsigned const& partial) { sum += partial; })
+    .to("sliding_sum");
+
+  std::atomic<unsigned> tumbling_total{};
+  std::atomic<unsigned> sliding_total{};
+  g.with(
+     "collect_tumbling", [&](unsigned sum) { tumbling_total += sum; }, concurrency::unlimited)
+    .monitor("tumbling_sum");
+  g.with(
+     "collect_sliding", [&](unsigned sum) { sliding_total += sum; }, concurrency::unlimited)
+    .monitor("sliding_sum");
+
+  g.execute();
+
+  CHECK(g.execution_counts("tumbling_add") == run_limit * event_limit);
+  CHECK(g.execution_counts("collect_tumbling") == run_limit * 3);
+  CHECK(tumbling_total == run_limit * (3u + 12u + 21u));
+  CHECK(g.execution_counts("collect_sliding") == run_limit * 4);
+  CHECK(sliding_total == run_limit * (6u + 14u + 22u + 30u));
+}
@@ -0,0 +1,170 @@
+// =======================================================================================
+// This test verifies the ready-made histogram, running-statistics, and extrema reduction
+// types, both when filled directly and when filled by reductions whose partial results are
+// accumulated per thread.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/core/reduction/statistics.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+
+#include "catch2/catch_all.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace meld;
+using Catch::Matchers::WithinRel;
+
+namespace {
+  constexpr unsigned index_limit{2u};
+  constexpr unsigned number_limit{1000u};
+}
+
+TEST_CASE("Histogram", "[reduction]")
+{
+  histogram h{4, 0., 2.};
+  for (double x : {-1., 0., 0.4, 0.5, 1.2, 1.99, 2., std::numeric_limits<double>::quiet_NaN()}) {
+    h.fill(x);
+  }
+  CHECK(h.n_bins() == 4ull);
+  CHECK(h.entries() == 8ull);
+  CHECK(h.underflow() == 2ull);
+  CHECK(h.count(0) == 2ull);
+  CHECK(h.count(1) == 1ull);
+  CHECK(h.count(2) == 1ull);
+  CHECK(h.count(3) == 1ull);
+  CHECK(h.overflow() == 1ull);
+
+  histogram other{4, 0., 2.};
+  other.fill(0.7);
+  h.merge(other);
+  CHECK(h.count(1) == 2ull);
+  CHECK(h.entries() == 9ull);
+}
+
+TEST_CASE("Running statistics", "[reduction]")
+{
+  std::vector<double> const values{2., 4., 4., 4., 5., 5., 7., 9.};
+  running_stats all;
+  running_stats first_half;
+  running_stats second_half;
+  for (std::size_t i = 0; i != values.size(); ++i) {
+    all.add(values[i]);
+    (i < 3 ? first_half : second_half).add(values[i]);
+  }
+  CHECK(all.count() == 8ull);
+  CHECK_THAT(all.mean(), WithinRel(5.));
+  CHECK_THAT(all.variance(), WithinRel(32. / 7.));
+
+  first_half.merge(second_half);
+  first_half.merge(running_stats{});
+  CHECK(first_half.count() == 8ull);
+  CHECK_THAT(first_half.mean(), WithinRel(5.));
+  CHECK_THAT(first_half.variance(), WithinRel(32. / 7.));
+}
+
+TEST_CASE("Extrema", "[reduction]")
+{
+  extrema<int> e;
+  CHECK(e.empty());
+  e.add(3);
+  extrema<int> other;
+  other.add(-2);
+  other.add(8);
+  e.merge(other);
+  CHECK(e.min() == -2);
+  CHECK(e.max() == 8);
+}
+
+TEST_CASE("Statistics reductions", "[graph]")
+{
+  std::vector<level_id_ptr> levels;
+  levels.reserve(1 + index_limit * (number_limit + 1u));
+  auto job_id = levels.emplace_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != index_limit; ++i) {
+    auto run_id = levels.emplace_back(job_id->make_child(i, "run"));
+    for (unsigned j = 0u; j != number_limit; ++j) {
+      levels.push_back(run_id->make_child(j, "event"));
+    }
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+    if (it == e) {
+      return nullptr;
+    }
+    auto const& id = *it++;
+
+    auto store = cached_stores.get_store(id);
+    if (id->level_name() == "event") {
+      store->add_product("value", static_cast<double>(id->number()) / number_limit);
+    }
+    return store;
+  }};
+
+  g.with("fill_values", fill_histogram, concurrency::unlimited)
+    .reduce("value")
+    .for_each("run")
+    .to("value_histogram")
+    .initialized_with(10, 0., 1.)
+    .combined();
+  g.with("value_stats", accumulate_stats, concurrency::unlimited)
+    .reduce("value")
+    .for_each("run")
+    .to("value_summary")
+    .combined();
+  g.with("value_extrema", find_extrema<double>, concurrency::unlimited)
+    .reduce("value")
+    .to("value_range")
+    .combined();
+
+  g.with(
+     "check_histogram",
+     [](histogram const& h) {
+       CHECK(h.entries() == number_limit);
+       for (std::size_t i = 0; i != h.n_bins(); ++i) {
+         CHECK(h.count(i) == number_limit / 10);
+       }
+     },
+     concurrency::unlimited)
+    .monitor("value_histogram");
+  g.with(
+     "check_stats",
+     [](running_stats const& s) {
+       CHECK(s.count() == number_limit);
+       CHECK_THAT(s.mean(), WithinRel(0.4995));
+       // Sample variance of the values i/n for i in [0, n)
+       auto const variance = (number_limit + 1.) / (12. * number_limit);
+       CHECK_THAT(s.standard_deviation(), WithinRel(std::sqrt(variance)));
+     },
+     concurrency::unlimited)
+    .monitor("value_summary");
+  g.with(
+     "check_range",
+     [](extrema<double> const& r) {
+       CHECK(r.min() == 0.);
+       CHECK_THAT(r.max(), WithinRel(0.999));
+     },
+     concurrency::unlimited)
+    .monitor("value_range");
+
+  g.execute();
+
+  CHECK(g.execution_counts("fill_values") == index_limit * number_limit);
+  CHECK(g.execution_counts("check_histogram") == index_limit);
+  CHECK(g.execution_counts("check_stats") == index_limit);
+  CHECK(g.execution_counts("check_range") == 1);
+}
+
+TEST_CASE("Uninitialized histogram reduction", "[graph]")
+{
+  framework_graph g{product_store::base()};
+  CHECK_THROWS_WITH(
+    g.with("fill_values", fill_histogram).reduce("value").for_each("run").to("value_histogram"),
+    Catch::Matchers::ContainsSubstring("must be initialized"));
+}
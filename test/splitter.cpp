@@ -23,7 +23,9 @@
 #include "catch2/catch_all.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace meld;
@@ -61,6 +63,92 @@ namespace {
     numbers_t::const_iterator end_;
   };
 
+  // Indexed unfold, whose children are created in parallel chunks
+  class segments {
+  public:
+    explicit segments(unsigned int n_segments) : n_{n_segments} {}
+    std::size_t initial_value() const { return 0; }
+    std::size_t size() const { return n_; }
+    bool predicate(std::size_t i) const { return i != n_; }
+    auto unfold(std::size_t i) const { return std::make_pair(i + 1, static_cast<unsigned>(i)); }
+
+  private:
+    unsigned int n_;
+  };
+
+  // Indexed unfold whose predicate stops before size() is reached; unless chunked
+  // unfolding is requested, the predicate decides how many children are created.
+  class first_segments {
+  public:
+    explicit first_segments(unsigned int n_segments) : n_{n_segments} {}
+    std::size_t initial_value() const { return 0; }
+    std::size_t size() const { return n_; }
+    bool predicate(std::size_t i) const { return i != n_ / 2; }
+    auto unfold(std::size_t i) const { return std::make_pair(i + 1, static_cast<unsigned>(i)); }
+
+  private:
+    unsigned int n_;
+  };
+
+  // Records how many children have been created but not yet processed
+  std::atomic<unsigned int> created_children{};
+  std::atomic<unsigned int> processed_children{};
+  std::atomic<unsigned int> max_outstanding{};
+
+  class counted_iota {
+  public:
+    explicit counted_iota(unsigned int max_number) : max_{max_number} {}
+    unsigned int initial_value() const { return 0; }
+    bool predicate(unsigned int i) const { return i != max_; }
+    auto unfold(unsigned int i) const
+    {
+      auto const outstanding = ++created_children - processed_children;
+      auto current = max_outstanding.load();
+      while (outstanding > current and
+             not max_outstanding.compare_exchange_weak(current, outstanding)) {}
+      return std::make_pair(i + 1, i);
+    };
+
+  private:
+    unsigned int max_;
+  };
+
+  // Unfolds n copies of its value
+  class repeat_value {
+  public:
+    explicit repeat_value(unsigned int value) : value_{value} {}
+    unsigned int initial_value() const { return 0; }
+    bool predicate(unsigned int i) const { return i != 3u; }
+    auto unfold(unsigned int i) const { return std::make_pair(i + 1, value_); };
+
+  private:
+    unsigned int value_;
+  };
+
+  // Records how many unfold calls are active at the same time
+  std::atomic<unsigned int> active_unfolds{};
+  std::atomic<unsigned int> max_active_unfolds{};
+
+  class serial_iota {
+  public:
+    explicit serial_iota(unsigned int max_number) : max_{max_number} {}
+    unsigned int initial_value() const { return 0; }
+    bool predicate(unsigned int i) const { return i != max_; }
+    auto unfold(unsigned int i) const
+    {
+      auto const active = ++active_unfolds;
+      auto current = max_active_unfolds.load();
+      while (active > current and
+             not max_active_unfolds.compare_exchange_weak(current, active)) {}
+      std::this_thread::sleep_for(std::chrono::microseconds{50});
+      --active_unfolds;
+      return std::make_pair(i + 1, i);
+    };
+
+  private:
+    unsigned int max_;
+  };
+
   void add(std::atomic<unsigned int>& counter, unsigned number) { counter += number; }
   void add_numbers(std::atomic<unsigned int>& counter, unsigned number) { counter += number; }
 
@@ -135,3 +223,216 @@ TEST_CASE("Splitting the processing", "[graph]")
   CHECK(g.execution_counts("add_numbers") == 20);
   CHECK(g.execution_counts("check_sum_same") == index_limit);
 }
+
+TEST_CASE("Splitting in parallel chunks", "[graph]")
+{
+  constexpr auto index_limit = 2u;
+  constexpr static auto n_segments = 1000u;
+  std::vector<level_id_ptr> levels;
+  levels.reserve(index_limit + 1u);
+  levels.push_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != index_limit; ++i) {
+    levels.push_back(level_id::base().make_child(i, "event"));
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+    if (it == e) {
+      return nullptr;
+    }
+    auto const& id = *it++;
+
+    auto store = cached_stores.get_store(id);
+    if (store->id()->level_name() == "event") {
+      store->add_product("n_segments", unsigned{n_segments});
+    }
+    return store;
+  }};
+
+  g.with<segments>(&segments::predicate, &segments::unfold, concurrency::unlimited)
+    .split("n_segments")
+    .into("segment")
+    .within_family("segment")
+    .in_chunks_of(64);
+  g.with(add, concurrency::unlimited).reduce("segment").for_each("event").to("segment_sum");
+  g.with(
+     "check_segment_sum",
+     [](unsigned int sum) { CHECK(sum == n_segments * (n_segments - 1) / 2); },
+     concurrency::unlimited)
+    .monitor("segment_sum");
+
+  // Without 'in_chunks_of', an indexed object is unfolded with its predicate.
+  constexpr static auto n_first = n_segments / 2;
+  g.with<first_segments>(
+     &first_segments::predicate, &first_segments::unfold, concurrency::unlimited)
+    .split("n_segments")
+    .into("first_segment")
+    .within_family("first_segment");
+  g.with("add_first", add, concurrency::unlimited)
+    .reduce("first_segment")
+    .for_each("event")
+    .to("first_segment_sum");
+  g.with(
+     "check_first_segment_sum",
+     [](unsigned int sum) { CHECK(sum == n_first * (n_first - 1) / 2); },
+     concurrency::unlimited)
+    .monitor("first_segment_sum");
+
+  g.execute();
+
+  CHECK(g.execution_counts("segments") == index_limit);
+  CHECK(g.execution_counts("add") == index_limit * n_segments);
+  CHECK(g.execution_counts("check_segment_sum") == index_limit);
+  CHECK(g.execution_counts("add_first") == index_limit * n_first);
+  CHECK(g.execution_counts("check_first_segment_sum") == index_limit);
+}
+
+TEST_CASE("Splitting lazily", "[graph]")
+{
+  constexpr auto index_limit = 2u;
+  constexpr auto max_children = 4u;
+  std::vector<level_id_ptr> levels;
+  levels.reserve(index_limit + 1u);
+  levels.push_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != index_limit; ++i) {
+    levels.push_back(level_id::base().make_child(i, "event"));
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+    if (it == e) {
+      return nullptr;
+    }
+    auto const& id = *it++;
+
+    auto store = cached_stores.get_store(id);
+    if (store->id()->level_name() == "event") {
+      store->add_product<unsigned>("max_number", 100u * (id->number() + 1));
+    }
+    return store;
+  }};
+
+  g.with<counted_iota>(&counted_iota::predicate, &counted_iota::unfold, concurrency::unlimited)
+    .split("max_number")
+    .into("new_number")
+    .within_family("lower")
+    .limit_outstanding_children(max_children);
+  g.with(
+     "count_child", [](unsigned) { ++processed_children; }, concurrency::unlimited)
+    .monitor("new_number");
+  g.with(add, concurrency::unlimited).reduce("new_number").for_each("event").to("sum");
+  g.with(
+     "check_lazy_sum",
+     [](handle<unsigned int> const sum) {
+       CHECK(*sum == (sum.level_id().number() == 0ull ? 4950u : 19900u));
+     },
+     concurrency::unlimited)
+    .monitor("sum");
+
+  g.execute();
+
+  CHECK(g.execution_counts("counted_iota") == index_limit);
+  CHECK(g.execution_counts("count_child") == 300u);
+  CHECK(g.execution_counts("check_lazy_sum") == index_limit);
+  // The children of both events may be outstanding at the same time.
+  CHECK(max_outstanding <= index_limit * max_children);
+}
+
+TEST_CASE("Unfolding the children of a splitter further", "[graph]")
+{
+  constexpr auto index_limit = 2u;
+  std::vector<level_id_ptr> levels;
+  levels.reserve(index_limit + 1u);
+  levels.push_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != index_limit; ++i) {
+    levels.push_back(level_id::base().make_child(i, "event"));
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+    if (it == e) {
+      return nullptr;
+    }
+    auto const& id = *it++;
+
+    auto store = cached_stores.get_store(id);
+    if (store->id()->level_name() == "event") {
+      store->add_product("max_number", 10u);
+    }
+    return store;
+  }};
+
+  g.with<iota>(&iota::predicate, &iota::unfold, concurrency::unlimited)
+    .split("max_number")
+    .into("outer")
+    .within_family("lower1");
+  g.with<repeat_value>(&repeat_value::predicate, &repeat_value::unfold, concurrency::unlimited)
+    .split("outer")
+    .into("inner")
+    .within_family("lower2");
+  // Each child of the "lower2" level repeats the "outer" product of its parent.
+  g.with(
+     "square", [](unsigned int inner) { return inner * inner; }, concurrency::unlimited)
+    .transform("inner")
+    .to("product");
+  g.with(add, concurrency::unlimited).reduce("product").for_each("lower1").to("sum");
+  g.with(
+     "check_product_sum",
+     [](handle<unsigned int> const sum) {
+       auto const outer = static_cast<unsigned int>(sum.level_id().number());
+       CHECK(*sum == 3u * outer * outer);
+     },
+     concurrency::unlimited)
+    .monitor("sum");
+
+  g.execute();
+
+  CHECK(g.execution_counts("repeat_value") == index_limit * 10u);
+  CHECK(g.execution_counts("square") == index_limit * 30u);
+  CHECK(g.execution_counts("check_product_sum") == index_limit * 10u);
+}
+
+TEST_CASE("Splitting lazily with a serial unfold", "[graph]")
+{
+  constexpr auto index_limit = 4u;
+  std::vector<level_id_ptr> levels;
+  levels.reserve(index_limit + 1u);
+  levels.push_back(level_id::base_ptr());
+  for (unsigned i = 0u; i != index_limit; ++i) {
+    levels.push_back(level_id::base().make_child(i, "event"));
+  }
+
+  auto it = cbegin(levels);
+  auto const e = cend(levels);
+  framework_graph g{[it, e](cached_product_stores& cached_stores) mutable -> product_store_ptr {
+                      if (it == e) {
+                        return nullptr;
+                      }
+                      auto const& id = *it++;
+
+                      auto store = cached_stores.get_store(id);
+                      if (store->id()->level_name() == "event") {
+                        store->add_product("max_number", 50u);
+                      }
+                      return store;
+                    },
+                    8};
+
+  g.with<serial_iota>(&serial_iota::predicate, &serial_iota::unfold, concurrency::serial)
+    .split("max_number")
+    .into("new_number")
+    .within_family("lower")
+    .limit_outstanding_children(2);
+  g.with(add, concurrency::unlimited).reduce("new_number").for_each("event").to("sum");
+  g.with(
+     "check_serial_sum", [](unsigned int sum) { CHECK(sum == 1225u); }, concurrency::unlimited)
+    .monitor("sum");
+
+  g.execute();
+
+  CHECK(g.execution_counts("check_serial_sum") == index_limit);
+  CHECK(max_active_unfolds == 1u);
+}
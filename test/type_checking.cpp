@@ -0,0 +1,61 @@
+// =======================================================================================
+// This test verifies that product types are identified by registered type IDs, and that
+// mismatches between the types created and requested by framework nodes are reported
+// when the graph is finalized instead of when a product is first accessed.
+// =======================================================================================
+
+#include "meld/core/cached_product_stores.hpp"
+#include "meld/core/framework_graph.hpp"
+#include "meld/model/level_id.hpp"
+#include "meld/model/product_store.hpp"
+#include "meld/model/type_id.hpp"
+
+#include "catch2/catch_all.hpp"
+
+using namespace meld;
+
+namespace {
+  int square(int const i) { return i * i; }
+  void check_squared(double) {}
+  void check_squared_int(int const i) { CHECK(i >= 0); }
+
+  framework_graph make_graph()
+  {
+    return framework_graph{[done = false](cached_product_stores& cached_stores) mutable {
+      if (done) {
+        return product_store_ptr{};
+      }
+      done = true;
+      auto store = cached_stores.get_store(level_id::base_ptr());
+      store->add_product("number", 3);
+      return store;
+    }};
+  }
+}
+
+TEST_CASE("Registered type IDs", "[data model]")
+{
+  CHECK(type_id_for<int>() == type_id_for<int const&>());
+  CHECK(type_id_for<int>() == type_id{typeid(int)});
+  CHECK(type_id_for<int>() != type_id_for<double>());
+  CHECK(type_id_for<double>().name() == "double");
+  CHECK_FALSE(type_id{}.valid());
+}
+
+TEST_CASE("Matching product types", "[graph]")
+{
+  auto g = make_graph();
+  g.with("square", square).transform("number").to("squared");
+  g.with("check_squared_int", check_squared_int).monitor("squared");
+  g.execute("type_checking_t");
+  CHECK(g.execution_counts("check_squared_int") == 1u);
+}
+
+TEST_CASE("Mismatched product types", "[graph]")
+{
+  auto g = make_graph();
+  g.with("square", square).transform("number").to("squared");
+  g.with("check_squared", check_squared).monitor("squared");
+  CHECK_THROWS_WITH(g.execute("type_checking_mismatch_t"),
+                    Catch::Matchers::ContainsSubstring("creates it with type 'int'"));
+}